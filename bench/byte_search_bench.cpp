@@ -0,0 +1,88 @@
+#include "memory_region/byte_search.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <functional>
+#include <print>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct dataset {
+  std::string name{};
+  std::vector<std::byte> haystack{};
+  std::vector<std::byte> needle{};
+};
+
+// small alphabets produce many first/last byte hits and partial matches,
+// uniform bytes are the common case for heaps full of pointers and floats
+[[nodiscard]] dataset make_dataset(std::string name, std::size_t size,
+                                   std::size_t needle_size,
+                                   std::uint32_t alphabet) {
+  std::mt19937_64 rng{42};
+  dataset data{.name = std::move(name),
+               .haystack = std::vector<std::byte>(size),
+               .needle = std::vector<std::byte>(needle_size)};
+  for (auto &byte : data.haystack) {
+    byte = static_cast<std::byte>('a' + rng() % alphabet);
+  }
+  for (auto &byte : data.needle) {
+    byte = static_cast<std::byte>('a' + rng() % alphabet);
+  }
+  // planted at the very end so every search walks the whole buffer
+  std::ranges::copy(data.needle, data.haystack.end() -
+                                     static_cast<std::ptrdiff_t>(needle_size));
+  return data;
+}
+
+void run(std::string_view label, const dataset &data,
+         const std::function<std::size_t()> &search) {
+  const auto start = std::chrono::steady_clock::now();
+  const auto offset = search();
+  const auto elapsed = std::chrono::duration<double>(
+                           std::chrono::steady_clock::now() - start)
+                           .count();
+  const auto gigabytes =
+      static_cast<double>(data.haystack.size()) / (1024.0 * 1024 * 1024);
+  std::println("  {:<12} {:>8.3f}s {:>8.2f} GB/s  found at {}", label, elapsed,
+               gigabytes / elapsed, offset);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const auto gigabytes = argc > 1 ? std::stoull(argv[1]) : 2;
+  const auto needle_size = argc > 2 ? std::stoull(argv[2]) : 16;
+  const auto size = gigabytes * 1024 * 1024 * 1024;
+
+  std::println("buffer: {} GB, needle: {} bytes, active kernel: {}", gigabytes,
+               needle_size,
+               pp::search_kernel_to_str(pp::active_search_kernel()));
+
+  for (const auto alphabet : {256u, 4u}) {
+    const auto data = make_dataset(std::format("alphabet {}", alphabet), size,
+                                   needle_size, alphabet);
+    std::println("{}:", data.name);
+    run("std::search", data, [&] {
+      return static_cast<std::size_t>(
+          std::search(data.haystack.begin(), data.haystack.end(),
+                      data.needle.begin(), data.needle.end()) -
+          data.haystack.begin());
+    });
+    for (const auto kernel : {pp::search_kernel::SCALAR,
+                              pp::search_kernel::SSE42,
+                              pp::search_kernel::AVX2}) {
+      if (kernel > pp::active_search_kernel()) {
+        continue;
+      }
+      run(pp::search_kernel_to_str(kernel), data, [&] {
+        return pp::find_bytes(data.haystack, data.needle, kernel);
+      });
+    }
+  }
+  return EXIT_SUCCESS;
+}
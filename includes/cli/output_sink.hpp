@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <format>
+#include <initializer_list>
+#include <iterator>
+#include <optional>
+#include <print>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+
+namespace pp {
+
+enum class output_format { TEXT, JSONL, BINARY };
+
+[[nodiscard]] std::string_view output_format_to_str(output_format format);
+[[nodiscard]] std::optional<output_format>
+str_to_output_format(std::string_view name);
+
+// the format output_sinks use by default, text unless changed with
+// set_output_format, which the cli does for --format
+[[nodiscard]] output_format active_output_format() noexcept;
+void set_output_format(output_format format) noexcept;
+
+// a number meant to be read in hex, addresses mostly
+struct hex {
+  std::uint64_t value{0};
+};
+
+struct field {
+  std::string_view key{};
+  std::variant<std::uint64_t, hex, std::string_view> value{};
+};
+
+// buffers the results of a command and writes them to file in large blocks
+// when the buffer fills up and on destruction. every result is a record of
+// a kind and named fields, which comes out as
+// - TEXT: the line formatted for people, as commands always printed it
+// - JSONL: {"type":"<kind>","<key>":<value>,...}, one object per line, hex
+//   values as "0x..." strings
+// - BINARY: u32 size of the rest of the record, u8 kind size, kind, u8 field
+//   count and per field u8 key size, key, u8 type and the value: u64 for
+//   numbers (type 0) and hex (type 1), u32 size and bytes for strings
+//   (type 2). little endian.
+// not thread safe.
+class output_sink {
+  std::FILE *file_{nullptr};
+  output_format format_{output_format::TEXT};
+  std::size_t capacity_{0};
+  std::string buffer_{};
+
+  void write_json(std::string_view kind, std::initializer_list<field> fields);
+  void write_binary(std::string_view kind,
+                    std::initializer_list<field> fields);
+  void flush_if_full();
+
+public:
+  explicit output_sink(std::FILE *file = stdout,
+                       output_format format = active_output_format(),
+                       std::size_t capacity = 1024 * 1024);
+  output_sink(const output_sink &other) = delete;
+  output_sink &operator=(const output_sink &other) = delete;
+  ~output_sink();
+
+  [[nodiscard]] output_format format() const noexcept;
+
+  // text is only formatted for TEXT, and straight into the buffer
+  template <typename... Args>
+  void record(std::string_view kind, std::initializer_list<field> fields,
+              std::format_string<Args...> text, Args &&...args) {
+    switch (this->format_) {
+    case output_format::TEXT:
+      std::format_to(std::back_inserter(this->buffer_), text,
+                     std::forward<Args>(args)...);
+      this->buffer_ += '\n';
+      break;
+    case output_format::JSONL:
+      this->write_json(kind, fields);
+      break;
+    case output_format::BINARY:
+      this->write_binary(kind, fields);
+      break;
+    }
+    this->flush_if_full();
+  }
+
+  // a line for people around the results, such as a header or a total. it
+  // goes to stderr in the other formats so the records stay parseable.
+  template <typename... Args>
+  void note(std::format_string<Args...> text, Args &&...args) {
+    if (this->format_ == output_format::TEXT) {
+      std::format_to(std::back_inserter(this->buffer_), text,
+                     std::forward<Args>(args)...);
+      this->buffer_ += '\n';
+      this->flush_if_full();
+    } else {
+      this->flush();
+      std::println(stderr, text, std::forward<Args>(args)...);
+    }
+  }
+
+  void flush();
+};
+
+} // namespace pp
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "cli/output_sink.hpp"
+
 #include <cstdlib>
 #include <expected>
 #include <functional>
@@ -49,6 +51,16 @@ public:
     const auto &cmd = it->second;
     std::vector<std::string_view> args;
     for (int i = 2; i < argc; ++i) {
+      // --format applies to every command, so it is taken out here
+      if (std::string_view{argv[i]} == "--format" && i + 1 < argc) {
+        const auto format = str_to_output_format(argv[++i]);
+        if (!format) {
+          std::println(stderr, "Unknown output format: {}", argv[i]);
+          exit(EXIT_FAILURE);
+        }
+        set_output_format(*format);
+        continue;
+      }
       args.emplace_back(argv[i]);
     }
 
@@ -23,6 +23,12 @@ public:
   [[nodiscard]] std::vector<instruction>
   disassemble(std::span<const std::byte> data, std::uintptr_t address) const;
 
+  // Linear sweep over all of data, bytes that do not start a valid
+  // instruction are skipped one at a time instead of ending the sweep
+  [[nodiscard]] std::vector<instruction>
+  disassemble_all(std::span<const std::byte> data,
+                  std::uintptr_t address) const;
+
   // Disassemble process memory
   template <thread_or_process T>
   [[nodiscard]] std::vector<instruction>
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "disassembler/disassembler.hpp"
+#include "disassembler/instruction.hpp"
+#include "memory_region/memory_region.hpp"
+#include "process/process.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace pp {
+
+// a ';' separated sequence of instruction templates such as
+// "call qword ptr [rip + *]; test eax, eax" matching that many consecutive
+// instructions. a template is a mnemonic and, optionally, operands, both
+// globs where * stands for any run of characters and ? for any one. case and
+// whitespace do not matter, a template without operands matches any.
+class insn_pattern {
+  struct insn_template {
+    std::string mnemonic{};
+    std::optional<std::string> operands{};
+  };
+  std::vector<insn_template> templates_{};
+
+public:
+  explicit insn_pattern(std::string_view text);
+  [[nodiscard]] std::size_t size() const noexcept;
+  // whether the instructions at the front of insns match, back to back
+  [[nodiscard]] bool matches(std::span<const instruction> insns) const;
+};
+
+// decoded instructions of file backed regions kept on disk, so queries on a
+// module that was decoded before skip decoding. an entry is tied to the
+// region's address and size and to the file's inode, size and mtime, code
+// patched in memory after it was written is not seen. saving an entry drops
+// the ones the same mapping left at other addresses, so every mapping keeps
+// one entry however often the target is restarted.
+class decode_cache {
+  std::filesystem::path dir_{};
+
+public:
+  explicit decode_cache(std::filesystem::path dir);
+  // cache_dir() / "insns"
+  [[nodiscard]] static std::filesystem::path default_dir();
+
+  // nullopt when region has no usable entry
+  [[nodiscard]] std::optional<std::vector<instruction>>
+  load(const memory_region &region) const;
+  // does nothing for regions that are not file backed
+  void save(const memory_region &region,
+            std::span<const instruction> instructions) const;
+};
+
+// linear sweep over the readable parts of region
+[[nodiscard]] std::vector<instruction>
+decode_region(const process &proc, const memory_region &region,
+              const disassembler &disasm);
+
+struct insn_match {
+  std::uintptr_t address{0};
+  std::vector<instruction> instructions{};
+};
+
+// decodes regions on a work-stealing pool, one disassembler per worker, and
+// matches pattern against every instruction of them. regions found in cache
+// are not decoded, the others are added to it. sorted by address.
+[[nodiscard]] std::vector<insn_match>
+search_instructions(const process &proc, std::span<const memory_region> regions,
+                    const insn_pattern &pattern,
+                    const decode_cache *cache = nullptr,
+                    std::size_t threads = 0);
+
+} // namespace pp
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "memory_region/mem_backend.hpp"
+#include "process/process.hpp"
+
+#include <array>
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace pp {
+
+inline constexpr std::array<std::size_t, 4> calibration_sizes{
+    8, 4 * 1024, 64 * 1024, 8 * 1024 * 1024};
+
+struct backend_timing {
+  mem_backend backend{mem_backend::PROCESS_VM};
+  // whether the target was stopped under ptrace while it was measured
+  bool stopped{false};
+  std::size_t size{0};
+  // mean time of one read of size bytes
+  double latency_us{0};
+  double throughput_mib{0};
+};
+
+// times reads of every calibration size from the largest readable region of
+// proc. process_vm and proc_mem are measured while proc runs and again with
+// it stopped under ptrace, ptrace only while it is stopped. sizes larger than
+// the region are left out.
+[[nodiscard]] std::vector<backend_timing> calibrate_backends(const process &proc);
+
+// $XDG_CACHE_HOME/pp/backends, ~/.cache/pp/backends without it
+[[nodiscard]] std::filesystem::path calibration_path();
+// one line per timing, in a format load_calibration reads back
+void save_calibration(const std::filesystem::path &path,
+                      std::span<const backend_timing> timings);
+// empty when there is no file, lines it does not understand are skipped
+[[nodiscard]] std::vector<backend_timing>
+load_calibration(const std::filesystem::path &path);
+
+// the backend with the best throughput on a running target at the smallest
+// measured size that is at least size (the largest one for bigger
+// transfers), nullopt without timings for a running target
+[[nodiscard]] std::optional<mem_backend>
+fastest_backend(std::span<const backend_timing> timings, std::size_t size);
+
+} // namespace pp
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "util/type_traits.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace pp {
+
+// queues many small scattered reads and submits them with as few
+// process_vm_readv calls as possible. requests whose remote ranges follow each
+// other back to back share one remote iovec, and up to IOV_MAX iovecs go into
+// every call. a partial transfer only fails the request it stopped in, the
+// rest of the batch is resubmitted.
+class batch_reader {
+  struct request {
+    std::uintptr_t address{0};
+    std::span<std::byte> bytes{};
+  };
+
+  std::uint32_t id_{0};
+  std::vector<request> requests_{};
+
+public:
+  template <thread_or_process T>
+  explicit batch_reader(const T &t) : id_{get_id(t)} {}
+
+  // out has to stay valid until submit(), returns the index of the request
+  std::size_t add(std::uintptr_t address, std::span<std::byte> out);
+  [[nodiscard]] std::size_t size() const noexcept;
+  // reads every queued request and clears the queue. element i tells whether
+  // request i was read completely.
+  [[nodiscard]] std::vector<bool> submit();
+};
+
+// process_vm_writev counterpart of batch_reader. when PP_MEM_BACKEND or
+// set_mem_backend selected another backend, requests are written one by one
+// through it instead, so batched writes reach the same pages single ones do.
+class batch_writer {
+  struct request {
+    std::uintptr_t address{0};
+    std::span<const std::byte> bytes{};
+  };
+
+  std::uint32_t id_{0};
+  std::vector<request> requests_{};
+
+public:
+  template <thread_or_process T>
+  explicit batch_writer(const T &t) : id_{get_id(t)} {}
+
+  // data has to stay valid until submit(), returns the index of the request
+  std::size_t add(std::uintptr_t address, std::span<const std::byte> data);
+  [[nodiscard]] std::size_t size() const noexcept;
+  // element i tells whether request i was written completely
+  [[nodiscard]] std::vector<bool> submit();
+};
+
+} // namespace pp
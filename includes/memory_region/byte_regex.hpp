@@ -0,0 +1,56 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace pp {
+
+struct regex_match {
+  std::uintptr_t address{0};
+  std::size_t size{0};
+};
+
+// regular expression over raw bytes, compiled up front into three dfas that
+// share one byte class table: an unanchored forward one finds where the first
+// match ends, an unanchored reverse one walks back from there to the leftmost
+// start and an anchored forward one extends that start to the longest match.
+// every input byte costs one table lookup per pass and nothing backtracks.
+//
+// supported: literals, ., [...] classes with ranges and negation, \d \w \s
+// and their negations, \xhh, \n \r \t \0, groups, (?:...), |, * + ? {n}
+// {n,} {n,m} and a leading (?i). anchors and backreferences are not.
+class byte_regex {
+  static constexpr std::uint32_t match_flag = 1u << 31;
+
+  // transitions hold row offsets (state * class_count_) of the next state,
+  // match_flag is set when that state accepts. row 0 is the dead state.
+  struct dfa {
+    std::vector<std::uint32_t> transitions{};
+    std::uint32_t start{0};
+  };
+
+  std::array<std::uint16_t, 256> byte_class_{};
+  std::size_t class_count_{0};
+  dfa forward_{};
+  dfa reverse_{};
+  dfa anchored_{};
+  std::size_t max_match_size_{0};
+
+public:
+  // matches longer than max_match_size may be cut short or missed
+  explicit byte_regex(std::string_view pattern,
+                      std::size_t max_match_size = 4096);
+  [[nodiscard]] std::size_t max_match_size() const noexcept;
+
+  // {offset, size} of the leftmost-longest match starting at or after from,
+  // offset is haystack.size() if there is none
+  [[nodiscard]] std::pair<std::size_t, std::size_t>
+  find(std::span<const std::byte> haystack, std::size_t from = 0) const;
+};
+
+} // namespace pp
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <string_view>
+
+namespace pp {
+
+enum class search_kernel { SCALAR, SSE42, AVX2 };
+
+[[nodiscard]] std::string_view search_kernel_to_str(search_kernel kernel);
+
+// best kernel the cpu supports, detected once through cpuid
+[[nodiscard]] search_kernel active_search_kernel() noexcept;
+
+// offset of the first occurrence of needle in haystack, haystack.size() if
+// there is none. candidates are filtered on the first and last needle byte
+// before the rest is compared.
+[[nodiscard]] std::size_t
+find_bytes(std::span<const std::byte> haystack,
+           std::span<const std::byte> needle) noexcept;
+
+[[nodiscard]] std::size_t find_bytes(std::span<const std::byte> haystack,
+                                     std::span<const std::byte> needle,
+                                     search_kernel kernel) noexcept;
+
+} // namespace pp
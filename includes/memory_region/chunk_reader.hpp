@@ -0,0 +1,178 @@
+#pragma once
+
+#include "memory_region/memio.hpp"
+#include "memory_region/memory_region.hpp"
+#include "util/type_traits.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace pp {
+
+// fixed set of equally sized buffers handed out one at a time, acquire blocks
+// until a buffer is free. buffers are allocated on first use and never zeroed.
+class buffer_pool {
+  std::size_t buffer_size_{0};
+  std::size_t count_{0};
+  std::vector<std::unique_ptr<std::byte[]>> buffers_{};
+  std::vector<std::byte *> free_{};
+  std::mutex mutex_{};
+  std::condition_variable released_{};
+
+  void release(std::byte *buffer) noexcept;
+
+public:
+  class lease {
+    buffer_pool *pool_{nullptr};
+    std::byte *data_{nullptr};
+
+  public:
+    lease() = default;
+    lease(buffer_pool &pool, std::byte *data) : pool_{&pool}, data_{data} {}
+    lease(const lease &other) = delete;
+    lease &operator=(const lease &other) = delete;
+    lease(lease &&other) noexcept;
+    lease &operator=(lease &&other) noexcept;
+    ~lease() noexcept;
+    [[nodiscard]] std::span<std::byte> bytes() const noexcept;
+  };
+
+  explicit buffer_pool(std::size_t count = 4,
+                       std::size_t buffer_size = 8 * 1024 * 1024);
+  buffer_pool(const buffer_pool &pool) = delete;
+  buffer_pool &operator=(const buffer_pool &pool) = delete;
+
+  [[nodiscard]] std::size_t buffer_size() const noexcept;
+  [[nodiscard]] lease acquire();
+};
+
+struct scan_chunk {
+  // index into the scanned regions
+  std::size_t region{0};
+  std::uintptr_t begin{0};
+  // bytes owned by this chunk, matches must start inside them
+  std::size_t size{0};
+  // bytes read past the owned part so matches crossing the boundary are seen
+  std::size_t overlap{0};
+};
+
+[[nodiscard]] std::vector<scan_chunk>
+split_into_chunks(std::span<const memory_region> regions,
+                  std::size_t chunk_size, std::size_t overlap);
+
+struct memory_chunk {
+  std::size_t region{0};
+  std::uintptr_t address{0};
+  // owned bytes, bytes.size() - size bytes of overlap follow them
+  std::size_t size{0};
+  std::span<const std::byte> bytes{};
+};
+
+// streams regions through a buffer_pool as overlapping chunks of
+// pool.buffer_size() bytes. a yielded span stays valid until the iterator is
+// advanced. unreadable pages are read around, like scan_regions does, and
+// every readable piece of a chunk is yielded on its own, in address order.
+template <thread_or_process T> class chunk_reader {
+  const T *t_{nullptr};
+  buffer_pool *pool_{nullptr};
+  std::vector<scan_chunk> chunks_{};
+
+public:
+  class iterator {
+    const chunk_reader *reader_{nullptr};
+    std::size_t next_{0};
+    buffer_pool::lease lease_{};
+    memory_chunk current_{};
+    // readable pieces of the chunk last read, the next one to yield
+    std::vector<readable_range> ranges_{};
+    std::size_t next_range_{0};
+
+    void advance() {
+      while (true) {
+        if (this->next_range_ < this->ranges_.size()) {
+          const auto &chunk = this->reader_->chunks_[this->next_ - 1];
+          const auto &range = this->ranges_[this->next_range_++];
+          // pieces in the overlap belong to the next chunk
+          if (range.offset < chunk.size) {
+            this->current_ = {
+                .region = chunk.region,
+                .address = chunk.begin + range.offset,
+                .size = std::min(range.size, chunk.size - range.offset),
+                .bytes = this->lease_.bytes().subspan(range.offset,
+                                                      range.size)};
+            return;
+          }
+          this->next_range_ = this->ranges_.size();
+        }
+        if (this->next_ == this->reader_->chunks_.size()) {
+          break;
+        }
+        const auto &chunk = this->reader_->chunks_[this->next_++];
+        auto ranges = read_memory_ranges(
+            *this->reader_->t_, chunk.begin,
+            this->lease_.bytes().first(chunk.size + chunk.overlap));
+        this->ranges_ =
+            ranges ? std::move(*ranges) : std::vector<readable_range>{};
+        this->next_range_ = 0;
+      }
+      this->reader_ = nullptr;
+      this->lease_ = {};
+    }
+
+  public:
+    using value_type = memory_chunk;
+    using difference_type = std::ptrdiff_t;
+
+    iterator() = default;
+    iterator(const iterator &other) = delete;
+    iterator &operator=(const iterator &other) = delete;
+    iterator(iterator &&other) noexcept = default;
+    iterator &operator=(iterator &&other) noexcept = default;
+    ~iterator() = default;
+    explicit iterator(const chunk_reader &reader)
+        : reader_{&reader}, lease_{reader.pool_->acquire()} {
+      this->advance();
+    }
+
+    [[nodiscard]] const memory_chunk &operator*() const noexcept {
+      return this->current_;
+    }
+    [[nodiscard]] const memory_chunk *operator->() const noexcept {
+      return &this->current_;
+    }
+    iterator &operator++() {
+      this->advance();
+      return *this;
+    }
+    [[nodiscard]] bool operator==(std::default_sentinel_t) const noexcept {
+      return this->reader_ == nullptr;
+    }
+  };
+
+  chunk_reader(const T &t, std::span<const memory_region> regions,
+               buffer_pool &pool, std::size_t overlap = 0)
+      : t_{&t}, pool_{&pool} {
+    if (overlap >= pool.buffer_size()) {
+      throw std::invalid_argument("chunk overlap must be smaller than the "
+                                  "buffers of the pool");
+    }
+    this->chunks_ =
+        split_into_chunks(regions, pool.buffer_size() - overlap, overlap);
+  }
+  chunk_reader(const chunk_reader &reader) = delete;
+  chunk_reader &operator=(const chunk_reader &reader) = delete;
+
+  [[nodiscard]] iterator begin() const { return iterator{*this}; }
+  [[nodiscard]] std::default_sentinel_t end() const noexcept { return {}; }
+};
+
+} // namespace pp
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "memory_region/memory_region.hpp"
+#include "memory_region/page_map.hpp"
+#include "process/process.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace pp {
+
+// pages a process wrote to since the last reset(), tracked through the
+// kernel's soft-dirty bits: reset() clears them through
+// /proc/<pid>/clear_refs and the next write to a page sets its bit in
+// pagemap again. rescans use it to reread only what changed.
+class dirty_page_set {
+  process proc_;
+  page_map pages_;
+
+public:
+  explicit dirty_page_set(const process &proc);
+
+  // clears the soft-dirty bits of every page of the process
+  void reset() const;
+  // one element per address in pages (each inside the page it stands for),
+  // true when that page was written since reset()
+  [[nodiscard]] std::vector<bool>
+  dirty_pages(std::span<const std::uintptr_t> pages) const;
+  // the dirty parts of regions, runs of dirty pages become one region that
+  // keeps the permissions and name of the region it was cut from
+  [[nodiscard]] std::vector<memory_region>
+  dirty_regions(std::span<const memory_region> regions) const;
+  // dirty parts of every region in process::memory_regions()
+  [[nodiscard]] std::vector<memory_region> dirty_regions() const;
+
+  // dirty_pages() and dirty_regions() followed by reset(). the process keeps
+  // running, so a page first written between the lookup and the reset has
+  // its bit cleared right away and is taken for clean until it is written
+  // again. the window is as long as the lookup, which grows with the
+  // regions looked up. closing it needs the target stopped, or the kernel's
+  // PAGEMAP_SCAN, whose write tracking only works for ranges the target
+  // registered with userfaultfd itself.
+  [[nodiscard]] std::vector<bool>
+  take_dirty_pages(std::span<const std::uintptr_t> pages) const;
+  [[nodiscard]] std::vector<memory_region>
+  take_dirty_regions(std::span<const memory_region> regions) const;
+};
+
+} // namespace pp
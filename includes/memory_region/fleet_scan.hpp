@@ -0,0 +1,74 @@
+#pragma once
+
+#include "memory_region/scanner.hpp"
+#include "process/process.hpp"
+#include "util/work_stealing_pool.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <expected>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace pp {
+
+// how a thread budget is shared by the scans of several processes
+struct fleet_budget {
+  // processes scanned at the same time
+  std::size_t concurrent{1};
+  // workers every one of those scans gets
+  std::size_t threads_per_scan{1};
+};
+
+// threads == 0 -> one thread per core. processes are scanned side by side
+// until every thread has one, whatever is left over is handed to each scan,
+// so the scans never run more than threads workers together.
+[[nodiscard]] fleet_budget split_thread_budget(std::size_t threads,
+                                               std::size_t processes);
+
+template <typename T> struct fleet_result {
+  std::uint32_t pid{0};
+  // what the scan returned, or why it failed, e.g. the process exited
+  std::expected<T, std::string> result{};
+  scan_stats stats{};
+};
+
+// runs scan(proc, options) for every process, several at a time within the
+// thread budget of options.threads. each scan gets its own copy of options
+// with its share of the threads and its own stats. one process failing does
+// not stop the others. results are in the order of procs.
+template <typename F,
+          typename T = std::invoke_result_t<F &, const process &,
+                                            const scan_options &>>
+[[nodiscard]] std::vector<fleet_result<T>>
+scan_fleet(std::span<const process> procs, const scan_options &options,
+           F &&scan) {
+  const auto budget = split_thread_budget(options.threads, procs.size());
+  std::vector<fleet_result<T>> results(procs.size());
+  const work_stealing_pool pool{budget.concurrent};
+  pool.run(procs.size(), [&](std::size_t, std::size_t task) {
+    auto &result = results[task];
+    result.pid = procs[task].pid();
+    auto own = options;
+    own.threads = budget.threads_per_scan;
+    own.stats = &result.stats;
+    try {
+      result.result = scan(procs[task], own);
+    } catch (const std::exception &e) {
+      result.result = std::unexpected{std::string{e.what()}};
+    }
+  });
+  if (options.stats != nullptr) {
+    *options.stats = {};
+    for (const auto &result : results) {
+      options.stats->pages_read += result.stats.pages_read;
+      options.stats->pages_skipped += result.stats.pages_skipped;
+    }
+  }
+  return results;
+}
+
+} // namespace pp
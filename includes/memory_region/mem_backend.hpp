@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <system_error>
+
+namespace pp {
+
+// how bytes move between pp and the target
+enum class mem_backend {
+  // process_vm_readv / process_vm_writev
+  PROCESS_VM,
+  // pread / pwrite on /proc/<pid>/mem
+  PROC_MEM,
+  // like PROC_MEM for single transfers, scans queue their chunk reads on an
+  // io_uring and match completed chunks while the rest are in flight
+  IO_URING,
+  // PTRACE_PEEKDATA / PTRACE_POKEDATA one word at a time, only works while
+  // pp has the target stopped under ptrace
+  PTRACE
+};
+
+[[nodiscard]] std::string_view mem_backend_to_str(mem_backend backend);
+[[nodiscard]] std::optional<mem_backend>
+str_to_mem_backend(std::string_view str) noexcept;
+
+// true when the kernel lets this process set up an io_uring, which seccomp
+// filters and the io_uring_disabled sysctl can forbid. checked once.
+[[nodiscard]] bool io_uring_supported() noexcept;
+
+// the backend chosen through set_mem_backend or PP_MEM_BACKEND from the
+// environment (process_vm, proc_mem, io_uring or ptrace), nullopt when
+// neither chose a supported one
+[[nodiscard]] std::optional<mem_backend> selected_mem_backend() noexcept;
+// selected_mem_backend(), PROCESS_VM when nothing is selected
+[[nodiscard]] mem_backend active_mem_backend() noexcept;
+// throws std::runtime_error when backend is not supported
+void set_mem_backend(mem_backend backend);
+// backend for a read of size bytes: the selected one if there is one,
+// otherwise the fastest one for that size according to the timings `pp
+// calibrate` saved, PROCESS_VM without them
+[[nodiscard]] mem_backend mem_backend_for(std::size_t size) noexcept;
+
+// bytes read from the start of [address, address + out.size()) through
+// mem_backend_for(out.size()). reads stop at the first unreadable page, which
+// is not an error.
+[[nodiscard]] std::expected<std::size_t, std::error_code>
+remote_read(std::uint32_t id, std::uintptr_t address, std::span<std::byte> out);
+[[nodiscard]] std::expected<std::size_t, std::error_code>
+remote_read(mem_backend backend, std::uint32_t id, std::uintptr_t address,
+            std::span<std::byte> out);
+// bytes written from the start of data, stops at the first unwritable page.
+// goes through active_mem_backend(), never a calibrated one: /proc/<pid>/mem
+// writes ignore page protections, so they have to be asked for explicitly.
+[[nodiscard]] std::expected<std::size_t, std::error_code>
+remote_write(std::uint32_t id, std::uintptr_t address,
+             std::span<const std::byte> data);
+[[nodiscard]] std::expected<std::size_t, std::error_code>
+remote_write(mem_backend backend, std::uint32_t id, std::uintptr_t address,
+             std::span<const std::byte> data);
+
+} // namespace pp
@@ -1,103 +1,196 @@
 #pragma once
 
+#include "batch_io.hpp"
+#include "byte_search.hpp"
+#include "mem_backend.hpp"
 #include "memory_region.hpp"
 #include "util/type_traits.hpp"
 
+#include <algorithm>
 #include <cassert>
+#include <cerrno>
 #include <cstddef>
 #include <cstring>
+#include <expected>
 #include <format>
+#include <limits>
 #include <optional>
+#include <span>
 #include <system_error>
 #include <vector>
 
 #ifdef __linux__
-#include <sys/uio.h>
+#include <unistd.h>
 #else
 #error "only linux is supported"
 #endif
 
 namespace pp {
 
+// transfers go through active_mem_backend()
+template <thread_or_process T>
+void read_memory(const T &t, std::uintptr_t address,
+                 std::span<std::byte> out) {
+  const auto read = remote_read(get_id(t), address, out);
+  if (!read || *read != out.size()) {
+    throw std::system_error(
+        read ? std::error_code{EFAULT, std::generic_category()} : read.error(),
+        std::format("failed to read memory beginning at: {:x}", address));
+  }
+}
+
+// bytes read from the start of [address, address + out.size()). reads stop at
+// the first unreadable page, which is not an error. errors are reserved for
+// failures such as the process being gone.
+template <thread_or_process T>
+[[nodiscard]] std::expected<std::size_t, std::error_code>
+try_read_memory(const T &t, std::uintptr_t address, std::span<std::byte> out) {
+  return remote_read(get_id(t), address, out);
+}
+
+struct readable_range {
+  std::size_t offset{0};
+  std::size_t size{0};
+};
+
+// reads everything readable in [address, address + out.size()) and returns
+// the sub-ranges of out that hold data, bytes outside of them are left as
+// they were. every short read pinpoints the first unreadable page, which is
+// skipped before the rest is read again.
+template <thread_or_process T>
+[[nodiscard]] std::expected<std::vector<readable_range>, std::error_code>
+read_memory_ranges(const T &t, std::uintptr_t address,
+                   std::span<std::byte> out) {
+  static const auto page_size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+  std::vector<readable_range> ranges{};
+  std::size_t offset = 0;
+  while (offset < out.size()) {
+    const auto read = try_read_memory(t, address + offset, out.subspan(offset));
+    if (!read) {
+      return std::unexpected{read.error()};
+    }
+    if (*read > 0) {
+      if (!ranges.empty() &&
+          ranges.back().offset + ranges.back().size == offset) {
+        ranges.back().size += *read;
+      } else {
+        ranges.push_back({.offset = offset, .size = *read});
+      }
+    }
+    offset += *read;
+    if (offset < out.size()) {
+      // step over the page the read stopped in
+      const auto failed = address + offset;
+      const auto next_page = (failed / page_size + 1) * page_size;
+      offset = std::min(out.size(), next_page - address);
+    }
+  }
+  return ranges;
+}
+
 template <thread_or_process T>
 [[nodiscard]] std::vector<std::byte>
 read_memory_region(const T &t, const memory_region &region,
                    std::optional<std::size_t> read_size = std::nullopt) {
-  {
-    std::vector<std::byte> mem{read_size.value_or(region.size())};
-#ifdef __linux__
-    std::uint32_t id = get_id(t);
-    iovec local{.iov_base = mem.data(), .iov_len = mem.size()};
-    iovec remote{.iov_base = reinterpret_cast<void *>(region.begin()),
-                 .iov_len = region.size()};
-
-    if (process_vm_readv(static_cast<std::int32_t>(id), &local, 1, &remote, 1,
-                         0) !=
-        static_cast<ssize_t>(read_size.value_or(region.size()))) {
-      throw std::system_error(
-          errno, std::generic_category(),
-          std::format("failed to read memory region beginning at: {:x}",
-                      region.begin()));
-    }
-#else
-#error "only linux is supported"
-#endif
-    return mem;
+  std::vector<std::byte> mem(std::min(read_size.value_or(region.size()),
+                                      region.size()));
+  const auto read = remote_read(get_id(t), region.begin(), mem);
+  if (!read || *read != mem.size()) {
+    throw std::system_error(
+        read ? std::error_code{EFAULT, std::generic_category()} : read.error(),
+        std::format("failed to read memory region beginning at: {:x}",
+                    region.begin()));
   }
+  return mem;
 }
 
 template <thread_or_process T>
 void write_memory_region(const T &t, const memory_region &region,
                          std::span<std::byte> data) {
   assert(data.size() <= region.size());
-#ifdef __linux__
-  iovec local{.iov_base = const_cast<void *>(
-                  reinterpret_cast<const void *>(data.data())),
-              .iov_len = data.size()};
-
-  iovec remote{.iov_base = reinterpret_cast<void *>(region.begin()),
-               .iov_len = data.size()};
-
-  std::uint32_t id = get_id(t);
-  if (process_vm_writev(static_cast<std::int32_t>(id), &local, 1, &remote, 1,
-                        0) != static_cast<ssize_t>(data.size())) {
+  const auto written = remote_write(get_id(t), region.begin(), data);
+  if (!written || *written != data.size()) {
     throw std::system_error(
-        errno, std::generic_category(),
+        written ? std::error_code{EFAULT, std::generic_category()}
+                : written.error(),
         std::format("failed to write to memory region beginning at: {:x}",
                     region.begin()));
   }
-#else
-#error "only linux is supported"
-#endif
 }
 
+struct replace_result {
+  // start of every patched occurrence, in address order
+  std::vector<std::uintptr_t> patches{};
+  // bytes written, what would be written for a dry run
+  std::size_t bytes{0};
+};
+
+// writes patch at every address through one batch_writer, so back to back
+// patches share a remote iovec and up to IOV_MAX of them go into each
+// process_vm_writev. addresses that could not be written are left out of the
+// result. a dry run only reports the patches.
 template <thread_or_process T>
-void replace_memory(const T &t, const memory_region &region,
-                    std::span<const std::byte> find,
-                    std::span<const std::byte> replace,
-                    std::optional<std::size_t> occurrences = std::nullopt) {
-  auto mem = read_memory_region(t, region);
-  auto mem_span = std::span(mem);
-  auto remaining_occurrences =
+replace_result write_patches(const T &t,
+                             std::span<const std::uintptr_t> addresses,
+                             std::span<const std::byte> patch,
+                             bool dry_run = false) {
+  replace_result result{};
+  if (dry_run) {
+    result.patches.assign(addresses.begin(), addresses.end());
+  } else {
+    batch_writer writer{t};
+    for (const auto address : addresses) {
+      writer.add(address, patch);
+    }
+    const auto written = writer.submit();
+    for (std::size_t i = 0; i < addresses.size(); ++i) {
+      if (written[i]) {
+        result.patches.push_back(addresses[i]);
+      }
+    }
+  }
+  result.bytes = result.patches.size() * patch.size();
+  return result;
+}
+
+// reads region once, collects the occurrences of find that do not overlap
+// each other's replacement and writes only the replaced bytes. occurrences
+// whose replacement would run past the end of region are left alone.
+template <thread_or_process T>
+replace_result replace_memory(const T &t, const memory_region &region,
+                              std::span<const std::byte> find,
+                              std::span<const std::byte> replace,
+                              std::optional<std::size_t> occurrences =
+                                  std::nullopt,
+                              bool dry_run = false) {
+  if (find.empty()) {
+    return {};
+  }
+  const auto mem = read_memory_region(t, region);
+  const auto mem_span = std::span<const std::byte>{mem};
+  const auto limit =
       occurrences.value_or(std::numeric_limits<std::size_t>::max());
-  while (!mem_span.empty() && (remaining_occurrences > 0)) {
-    if (const auto found = std::ranges::search(mem_span, find);
-        !found.empty()) {
-      const auto begin =
-          std::ranges::distance(std::cbegin(mem_span), std::cbegin(found));
-      std::memcpy(mem_span.data() + begin, replace.data(), replace.size());
-      write_memory_region(t, region, mem);
-      remaining_occurrences--;
-    } else {
+  const auto step = std::max(find.size(), replace.size());
+  std::vector<std::uintptr_t> addresses{};
+  std::size_t offset = 0;
+  while (addresses.size() < limit && offset < mem_span.size()) {
+    const auto rest = mem_span.subspan(offset);
+    const auto found = find_bytes(rest, find);
+    if (found == rest.size() || offset + found + replace.size() > mem.size()) {
       break;
     }
+    addresses.push_back(region.begin() + offset + found);
+    offset += found + step;
   }
+  return write_patches(t, addresses, replace, dry_run);
 }
 
 template <thread_or_process T, typename R>
-void replace_memory(const T &t, const memory_region &region, R &&find,
-                    R &&replace,
-                    std::optional<std::size_t> occurrences = std::nullopt)
+replace_result replace_memory(const T &t, const memory_region &region,
+                              R &&find, R &&replace,
+                              std::optional<std::size_t> occurrences =
+                                  std::nullopt,
+                              bool dry_run = false)
   requires std::ranges::contiguous_range<R>
 {
   const auto find_bytes =
@@ -105,12 +198,13 @@ void replace_memory(const T &t, const memory_region &region, R &&find,
   const auto replace_bytes =
       reinterpret_cast<const std::byte *>(std::ranges::data(replace));
 
-  replace_memory(t, region,
-                 {find_bytes, std::ranges::size(find) *
-                                  sizeof(std::ranges::range_value_t<R>)},
-                 {replace_bytes, std::ranges::size(replace) *
-                                     sizeof(std::ranges::range_value_t<R>)},
-                 occurrences);
+  return replace_memory(
+      t, region,
+      {find_bytes,
+       std::ranges::size(find) * sizeof(std::ranges::range_value_t<R>)},
+      {replace_bytes,
+       std::ranges::size(replace) * sizeof(std::ranges::range_value_t<R>)},
+      occurrences, dry_run);
 }
 
 } // namespace pp
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "memory_region/memory_region.hpp"
+#include "process/process.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+namespace pp {
+
+struct dump_options {
+  // regions are read in pieces of at most this many bytes
+  std::size_t chunk_size{8 * 1024 * 1024};
+  // 0 uses every core
+  std::size_t threads{0};
+  // also read pages that are not in ram, which faults them back in
+  bool include_swapped{false};
+};
+
+struct dumped_region {
+  memory_region region;
+  // where the region's bytes start in the dump
+  std::size_t offset{0};
+  // bytes that could be read, unreadable and skipped pages are left zero
+  std::size_t read{0};
+};
+
+struct dump_report {
+  std::vector<dumped_region> regions{};
+  std::size_t size{0};
+  std::size_t read{0};
+  // pages left out because they were swapped out or never touched
+  std::size_t pages_skipped{0};
+};
+
+// writes regions back to back into path and an index of them into
+// "<path>.index". the file is sized up front and mapped, and every chunk is
+// read from the process straight into the mapping on the work stealing pool,
+// so the bytes never pass through a buffer of ours. only pages the pagemap
+// reports resident are read unless options.include_swapped is set, so dumping
+// does not fault the target's swap back in. pages that are skipped or cannot
+// be read stay zero, holes on most file systems. the index has one
+// line per region: "begin-end permissions offset read name", numbers in hex
+// and [anonymous] for unnamed regions.
+dump_report dump_memory(const process &proc,
+                        std::span<const memory_region> regions,
+                        const std::filesystem::path &path,
+                        const dump_options &options = {});
+
+} // namespace pp
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "memory_region/memory_region.hpp"
+#include "process/process.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <sched.h>
+#else
+#error "only linux is supported"
+#endif
+
+namespace pp {
+
+// one line of /proc/<pid>/numa_maps, the placement of the region at begin
+struct numa_region {
+  std::uintptr_t begin{0};
+  // default, bind:0, interleave:0-1, ...
+  std::string policy{};
+  // pages on every node, indexed by node id
+  std::vector<std::size_t> pages{};
+  std::size_t page_size{0};
+
+  // the node holding most of the pages, nullopt with none resident
+  [[nodiscard]] std::optional<std::size_t> home_node() const;
+};
+
+// ids of the online nodes from /sys/devices/system/node/online, just node 0
+// on a machine without numa
+[[nodiscard]] std::vector<std::size_t> online_numa_nodes();
+
+// /proc/<pid>/numa_maps sorted by begin, empty when the kernel has no numa
+// support
+[[nodiscard]] std::vector<numa_region> numa_placement(const process &proc);
+
+// keeps the workers of a scan on the home node of the region they scan, so
+// reading it mostly does not cross sockets. placement is resolved once per
+// region from numa_maps, not per chunk: the pages of a region spread over
+// several nodes are all read from the node holding most of them. a worker
+// moves to another node's cpus only when its region's home node is there,
+// cpus outside the affinity the scan started with are never used. does
+// nothing on a single node machine. the calling thread, which also works,
+// gets its affinity back on destruction.
+class numa_pinning {
+  bool active_{false};
+  cpu_set_t original_{};
+  // indexed by node, the allowed cpus of every node
+  std::vector<std::optional<cpu_set_t>> node_cpus_{};
+  // indexed by region
+  std::vector<std::optional<std::size_t>> region_nodes_{};
+  // indexed by worker, the node it is pinned to
+  std::vector<std::optional<std::size_t>> worker_nodes_{};
+
+public:
+  numa_pinning(const process &proc, std::span<const memory_region> regions,
+               std::size_t workers);
+  numa_pinning(const numa_pinning &other) = delete;
+  numa_pinning &operator=(const numa_pinning &other) = delete;
+  ~numa_pinning();
+
+  // called on the worker before it reads a chunk of regions[region]
+  void enter(std::size_t worker, std::size_t region);
+};
+
+} // namespace pp
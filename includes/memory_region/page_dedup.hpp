@@ -0,0 +1,67 @@
+#pragma once
+
+#include "memory_region/byte_search.hpp"
+#include "memory_region/scanner.hpp"
+#include "process/process.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace pp {
+
+// non-cryptographic 64-bit hash for comparing pages. four 64-bit lanes each
+// multiply the two halves of a word xor'ed with a key that changes with the
+// position, like xxh3's accumulate step, 32 bytes at a time. the avx2 and
+// scalar kernels produce the same value.
+[[nodiscard]] std::uint64_t hash_page(std::span<const std::byte> page) noexcept;
+[[nodiscard]] std::uint64_t hash_page(std::span<const std::byte> page,
+                                      search_kernel kernel) noexcept;
+
+struct dedup_region {
+  // the region's name, [anonymous] for unnamed ones
+  std::string name{};
+  std::size_t pages{0};
+  // pages of it with the same content as a page counted before, what
+  // merging identical pages would free
+  std::size_t duplicates{0};
+};
+
+struct dedup_pair {
+  std::uint32_t first{0};
+  std::uint32_t second{0};
+  // distinct page contents both hold, what merging only across the two
+  // frees on top of merging within each
+  std::size_t shared{0};
+};
+
+struct dedup_report {
+  // exclusively mapped pages, the ones all other counts are about
+  std::size_t pages{0};
+  std::size_t unique{0};
+  std::size_t zero{0};
+  // pages already shared copy-on-write with a fork, merged by ksm or mapped
+  // by another process. merging them again frees nothing, so they are not
+  // hashed
+  std::size_t shared{0};
+  // sorted by duplicates, most first
+  std::vector<dedup_region> regions{};
+  // every pair with shared pages, most first
+  std::vector<dedup_pair> pairs{};
+  // processes that could not be scanned and why
+  std::vector<std::pair<std::uint32_t, std::string>> failed{};
+};
+
+// hashes every resident page of the writable regions of procs on the chunked
+// scanner, processes side by side within options.threads as scan_fleet does,
+// and groups pages by hash. pages the pagemap does not report as exclusively
+// mapped only count towards shared. pages are not compared byte by byte, so
+// counts are estimates off by the odd 64-bit collision.
+[[nodiscard]] dedup_report
+find_duplicate_pages(std::span<const process> procs,
+                     const scan_options &options = {});
+
+} // namespace pp
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "process/process.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace pp {
+
+// /proc/<pid>/pagemap of a process, one open descriptor shared by all readers
+class page_map {
+  int fd_{-1};
+
+  // raw 64 bit entries of the pages overlapping [address, address + size)
+  [[nodiscard]] std::vector<std::uint64_t> entries(std::uintptr_t address,
+                                                   std::size_t size) const;
+
+public:
+  explicit page_map(const process &proc);
+  page_map(const page_map &other) = delete;
+  page_map &operator=(const page_map &other) = delete;
+  page_map(page_map &&other) noexcept;
+  page_map &operator=(page_map &&other) noexcept;
+  ~page_map();
+
+  // one element per page overlapping [address, address + size), true when the
+  // page is in ram. swapped out and never touched pages are false, reading
+  // them would fault them in. one pread covers the whole range.
+  [[nodiscard]] std::vector<bool> resident_pages(std::uintptr_t address,
+                                                 std::size_t size) const;
+  // same layout, true when the page was written since the soft-dirty bits
+  // were last cleared
+  [[nodiscard]] std::vector<bool> soft_dirty_pages(std::uintptr_t address,
+                                                   std::size_t size) const;
+  // same layout, true when the page is in ram and mapped only here. pages
+  // still shared copy-on-write with a fork, merged by ksm or mapped by
+  // another process are false
+  [[nodiscard]] std::vector<bool> exclusive_pages(std::uintptr_t address,
+                                                  std::size_t size) const;
+};
+
+} // namespace pp
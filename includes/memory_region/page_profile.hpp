@@ -0,0 +1,46 @@
+#pragma once
+
+#include "memory_region/memory_region.hpp"
+#include "memory_region/scanner.hpp"
+#include "process/process.hpp"
+
+#include <cstddef>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace pp {
+
+enum class page_class { ZERO, LOW_ENTROPY, HIGH_ENTROPY };
+
+// shannon entropy of the byte histogram of bytes in bits per byte, 0 for
+// one repeated byte up to 8 for uniformly spread bytes
+[[nodiscard]] double byte_entropy(std::span<const std::byte> bytes);
+
+// zero when every byte is, low entropy below threshold bits per byte. a
+// threshold around 6 separates what compresses well in zram from data that
+// is already compressed or random.
+[[nodiscard]] page_class classify_page(std::span<const std::byte> page,
+                                       double threshold = 6.0);
+
+struct region_profile {
+  // the regions' name, [anonymous] for unnamed ones
+  std::string name{};
+  // regions sharing the name
+  std::size_t regions{0};
+  std::size_t resident{0};
+  std::size_t zero{0};
+  std::size_t low_entropy{0};
+  std::size_t high_entropy{0};
+  // mean over the resident pages
+  double entropy{0};
+};
+
+// classifies every resident page of regions on the chunked scanner, pages
+// that are not resident are neither read nor faulted in. one profile per
+// region name, most resident pages first.
+[[nodiscard]] std::vector<region_profile>
+profile_pages(const process &proc, std::span<const memory_region> regions,
+              double threshold = 6.0, const scan_options &options = {});
+
+} // namespace pp
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace pp {
+
+struct pattern_match {
+  std::size_t pattern{0};
+  std::uintptr_t address{0};
+};
+
+// aho-corasick automaton over many byte patterns, compiled into a dense dfa
+// so matching is one table load per input byte. bytes that appear in no
+// pattern share one column, which keeps the table small enough for the cache.
+class pattern_set {
+  static constexpr std::uint32_t match_flag = 1u << 31;
+
+  std::array<std::uint16_t, 256> byte_class_{};
+  std::size_t class_count_{0};
+  // row offsets (state * class_count_) of the next state, match_flag is set
+  // when that state ends at least one pattern
+  std::vector<std::uint32_t> transitions_{};
+  // patterns ending in a state, indexed by its row offset / class_count_
+  std::vector<std::uint32_t> output_begin_{};
+  std::vector<std::uint32_t> outputs_{};
+  std::vector<std::size_t> sizes_{};
+  std::size_t max_size_{0};
+
+public:
+  explicit pattern_set(std::span<const std::vector<std::byte>> patterns);
+  [[nodiscard]] std::size_t size() const noexcept;
+  [[nodiscard]] std::size_t pattern_size(std::size_t pattern) const noexcept;
+  [[nodiscard]] std::size_t max_pattern_size() const noexcept;
+
+  // calls on_match(pattern, offset) for every occurrence in haystack that
+  // starts before limit, in order of the offset it ends at
+  template <typename F>
+  void find_all(std::span<const std::byte> haystack, std::size_t limit,
+                F &&on_match) const {
+    std::uint32_t state = 0;
+    for (std::size_t i = 0; i < haystack.size(); ++i) {
+      state = this->transitions_[(state & ~match_flag) +
+                                 this->byte_class_[std::to_integer<std::size_t>(
+                                     haystack[i])]];
+      if ((state & match_flag) == 0) [[likely]] {
+        continue;
+      }
+      const auto id = (state & ~match_flag) / this->class_count_;
+      for (auto out = this->output_begin_[id];
+           out < this->output_begin_[id + 1]; ++out) {
+        const auto pattern = this->outputs_[out];
+        const auto start = i + 1 - this->sizes_[pattern];
+        if (start < limit) {
+          on_match(static_cast<std::size_t>(pattern), start);
+        }
+      }
+    }
+  }
+};
+
+} // namespace pp
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "memory_region/scanner.hpp"
+#include "process/process.hpp"
+
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace pp {
+
+// an aligned 8 byte word at address holding value, which points into a
+// readable region
+struct pointer_entry {
+  std::uintptr_t value{0};
+  std::uintptr_t address{0};
+};
+
+// the regions of a file mapped into the process. base is where the lowest
+// mapping of that file starts, module offsets are relative to it.
+struct module_range {
+  std::uintptr_t begin{0};
+  std::uintptr_t end{0};
+  std::uintptr_t base{0};
+  std::string name{};
+};
+
+// every pointer of a process sorted by value, so the pointers into a range
+// are one binary search away. save() writes it as a header, the entries and
+// the modules back to back and load() maps that file instead of reading it,
+// so a map of a big process can be queried again without rescanning.
+class pointer_map {
+  std::vector<pointer_entry> owned_{};
+  void *mapping_{nullptr};
+  std::size_t mapping_size_{0};
+  std::span<const pointer_entry> entries_{};
+  // sorted by begin
+  std::vector<module_range> modules_{};
+
+  pointer_map() = default;
+
+public:
+  pointer_map(const pointer_map &other) = delete;
+  pointer_map &operator=(const pointer_map &other) = delete;
+  pointer_map(pointer_map &&other) noexcept;
+  pointer_map &operator=(pointer_map &&other) noexcept;
+  ~pointer_map();
+
+  // one parallel pass over the readable regions of proc
+  [[nodiscard]] static pointer_map build(const process &proc,
+                                         const scan_options &options = {});
+  [[nodiscard]] static pointer_map load(const std::filesystem::path &path);
+  void save(const std::filesystem::path &path) const;
+
+  [[nodiscard]] std::span<const pointer_entry> entries() const noexcept;
+  [[nodiscard]] std::span<const module_range> modules() const noexcept;
+  // entries whose value lies in [low, high]
+  [[nodiscard]] std::span<const pointer_entry>
+  pointing_into(std::uintptr_t low, std::uintptr_t high) const noexcept;
+  // the module address lies in, nullptr when it is not in one
+  [[nodiscard]] const module_range *
+  module_of(std::uintptr_t address) const noexcept;
+};
+
+// [[[module base + offset] + offsets[0]] + offsets[1]] ... ends at the target
+struct pointer_chain {
+  std::string module{};
+  std::uintptr_t offset{0};
+  std::vector<std::size_t> offsets{};
+
+  auto operator<=>(const pointer_chain &other) const = default;
+};
+
+struct chain_options {
+  // pointers followed from a module to the target
+  std::size_t max_depth{5};
+  // largest offset added to a pointer on the way
+  std::size_t max_offset{0x1000};
+  std::size_t max_chains{10'000};
+  // addresses carried to the next level, bounds the search on big maps
+  std::size_t max_frontier{100'000};
+};
+
+// breadth first from target back to module addresses through the pointers
+// pointing at most max_offset below each address. chains are sorted, shorter
+// chains are found first.
+[[nodiscard]] std::vector<pointer_chain>
+find_pointer_chains(const pointer_map &map, std::uintptr_t target,
+                    const chain_options &options = {});
+
+// the chains in both a and b, which have to be sorted. chains found for the
+// same value in two runs of a program are the ones that survive restarts.
+[[nodiscard]] std::vector<pointer_chain>
+intersect_chains(std::span<const pointer_chain> a,
+                 std::span<const pointer_chain> b);
+
+} // namespace pp
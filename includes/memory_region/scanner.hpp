@@ -0,0 +1,282 @@
+#pragma once
+
+#include "memory_region/byte_regex.hpp"
+#include "memory_region/chunk_reader.hpp"
+#include "memory_region/mem_backend.hpp"
+#include "memory_region/memio.hpp"
+#include "memory_region/memory_region.hpp"
+#include "memory_region/numa.hpp"
+#include "memory_region/page_map.hpp"
+#include "memory_region/pattern_set.hpp"
+#include "memory_region/signature.hpp"
+#include "memory_region/throttle.hpp"
+#include "memory_region/uring_reader.hpp"
+#include "process/process.hpp"
+#include "util/work_stealing_pool.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace pp {
+
+struct scan_stats {
+  std::size_t pages_read{0};
+  // pages left out because they were swapped out or never touched
+  std::size_t pages_skipped{0};
+};
+
+struct scan_options {
+  std::size_t chunk_size{8 * 1024 * 1024};
+  // 0 -> one worker per core
+  std::size_t threads{0};
+  // also read pages that are not in ram, which faults them back in
+  bool include_swapped{false};
+  // filled in at the end of the scan when set
+  scan_stats *stats{nullptr};
+  // every chunk read waits for it when set, scans given the same one share
+  // its rate
+  rate_limiter *limiter{nullptr};
+  // move each worker to the numa node holding most of the region it scans,
+  // one node per region rather than per chunk. finding the nodes reads
+  // /proc/<pid>/numa_maps, which walks all page tables of the target under
+  // its mmap lock, so it is skipped for scans of less than 256 MB and for
+  // throttled scans. nothing happens on single node machines.
+  bool numa_local{true};
+  // reads the io_uring backend keeps in flight, each holding a buffer of
+  // chunk_size bytes plus overlap. 0 fits as many as 256 MB of buffers hold,
+  // between 4 and 64, which is 32 for the default chunk size.
+  std::size_t queue_depth{0};
+};
+
+// readable sub-ranges of out after reading [address, address + out.size()),
+// only pages resident according to pages are read unless it is null. pages
+// starting in the first owned bytes are counted in stats.
+[[nodiscard]] std::expected<std::vector<readable_range>, std::error_code>
+read_resident_ranges(const process &proc, const page_map *pages,
+                     std::uintptr_t address, std::span<std::byte> out,
+                     std::size_t owned, scan_stats &stats);
+
+namespace detail {
+
+// unreadable or skipped pages split a chunk, only ranges starting in the part
+// the chunk owns are handed on
+template <typename R, typename F>
+void hand_on_ranges(const scan_chunk &chunk, std::span<const std::byte> bytes,
+                    std::span<const readable_range> ranges, F &fn,
+                    std::vector<R> &out) {
+  for (const auto &range : ranges) {
+    if (range.offset >= chunk.size) {
+      break;
+    }
+    fn(memory_chunk{.region = chunk.region,
+                    .address = chunk.begin + range.offset,
+                    .size = std::min(range.size, chunk.size - range.offset),
+                    .bytes = bytes.subspan(range.offset, range.size)},
+       out);
+  }
+}
+
+// scan_regions for the io_uring backend. one thread keeps a queue of chunk
+// reads in flight and runs fn on each chunk as soon as its read completes, so
+// reading and matching overlap without a pool. chunks with pages that are not
+// resident, and reads that come back short, take the synchronous path that
+// reads around the holes.
+template <typename R, typename F>
+[[nodiscard]] std::vector<R>
+scan_regions_async(const process &proc, std::span<const memory_region> regions,
+                   std::size_t overlap, const scan_options &options, F &fn) {
+  static const auto page_size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+  const auto chunks = split_into_chunks(regions, options.chunk_size, overlap);
+  // every read in flight holds a chunk sized buffer, which bounds the memory
+  // of the scan to depth buffers
+  constexpr std::size_t max_queued_bytes = 256 * 1024 * 1024;
+  const auto depth =
+      options.queue_depth != 0
+          ? options.queue_depth
+          : std::clamp<std::size_t>(
+                max_queued_bytes / (options.chunk_size + overlap), 4, 64);
+  uring_reader reader{proc.pid(), depth};
+  buffer_pool buffers{reader.depth(), options.chunk_size + overlap};
+  std::optional<page_map> pages{};
+  if (!options.include_swapped) {
+    pages.emplace(proc);
+  }
+  std::vector<buffer_pool::lease> leases(chunks.size());
+  std::vector<R> results{};
+  scan_stats stats{};
+
+  const auto read_sync = [&](const scan_chunk &chunk,
+                             std::span<std::byte> bytes) {
+    const auto ranges = read_resident_ranges(
+        proc, pages ? &*pages : nullptr, chunk.begin, bytes, chunk.size, stats);
+    if (ranges) {
+      hand_on_ranges(chunk, bytes, *ranges, fn, results);
+    }
+  };
+  const auto all_resident = [&](const scan_chunk &chunk, std::size_t size) {
+    if (!pages) {
+      return true;
+    }
+    try {
+      return std::ranges::all_of(pages->resident_pages(chunk.begin, size),
+                                 std::identity{});
+    } catch (const std::system_error &) {
+      return false;
+    }
+  };
+
+  std::size_t next = 0;
+  const auto fill = [&] {
+    while (next < chunks.size() && reader.in_flight() < reader.depth()) {
+      const auto task = next++;
+      const auto &chunk = chunks[task];
+      auto lease = buffers.acquire();
+      const auto bytes = lease.bytes().first(chunk.size + chunk.overlap);
+      if (options.limiter != nullptr) {
+        options.limiter->acquire(bytes.size());
+      }
+      if (!all_resident(chunk, bytes.size())) {
+        read_sync(chunk, bytes);
+        continue;
+      }
+      reader.add(task, chunk.begin, bytes);
+      leases[task] = std::move(lease);
+    }
+    reader.submit();
+  };
+
+  fill();
+  while (reader.in_flight() > 0) {
+    const auto done = reader.wait();
+    const auto task = static_cast<std::size_t>(done.tag);
+    const auto &chunk = chunks[task];
+    {
+      // released before fill() leases a buffer for the next read
+      const auto lease = std::move(leases[task]);
+      const auto bytes = lease.bytes().first(chunk.size + chunk.overlap);
+      if (done.read && *done.read == bytes.size()) {
+        stats.pages_read += (chunk.begin + chunk.size + page_size - 1) /
+                                page_size -
+                            chunk.begin / page_size;
+        const readable_range whole{.offset = 0, .size = bytes.size()};
+        hand_on_ranges(chunk, bytes, std::span{&whole, 1}, fn, results);
+      } else {
+        read_sync(chunk, bytes);
+      }
+    }
+    fill();
+  }
+
+  if (options.stats != nullptr) {
+    *options.stats = stats;
+  }
+  return results;
+}
+
+} // namespace detail
+
+// runs fn(chunk, out) for every readable chunk on a work-stealing pool, or on
+// one thread overlapping io_uring reads with fn under the IO_URING backend. a
+// chunk with unreadable or non-resident pages is passed on as its readable
+// pieces. each worker reads into a buffer leased from a pool with one buffer
+// per worker, so memory use is bounded by threads * (chunk_size + overlap).
+// every worker appends to its own vector, they are concatenated at the end so
+// the result is in no particular order. on numa machines pool workers follow
+// their chunks to the node holding most of their region.
+template <typename R, typename F>
+[[nodiscard]] std::vector<R>
+scan_regions(const process &proc, std::span<const memory_region> regions,
+             std::size_t overlap, const scan_options &options, F &&fn) {
+  if (active_mem_backend() == mem_backend::IO_URING) {
+    return detail::scan_regions_async<R>(proc, regions, overlap, options, fn);
+  }
+  const auto chunks = split_into_chunks(regions, options.chunk_size, overlap);
+  const work_stealing_pool pool{options.threads};
+  buffer_pool buffers{pool.size(), options.chunk_size + overlap};
+  std::optional<page_map> pages{};
+  if (!options.include_swapped) {
+    pages.emplace(proc);
+  }
+  std::vector<std::vector<R>> results(pool.size());
+  std::vector<scan_stats> stats(pool.size());
+  constexpr std::size_t min_numa_local_bytes = 256 * 1024 * 1024;
+  std::size_t scanned_bytes = 0;
+  for (const auto &region : regions) {
+    scanned_bytes += region.size();
+  }
+  std::optional<numa_pinning> pinning{};
+  if (options.numa_local && options.limiter == nullptr &&
+      scanned_bytes >= min_numa_local_bytes) {
+    pinning.emplace(proc, regions, pool.size());
+  }
+
+  pool.run(chunks.size(), [&](std::size_t worker, std::size_t task) {
+    const auto &chunk = chunks[task];
+    if (pinning) {
+      pinning->enter(worker, chunk.region);
+    }
+    const auto buffer = buffers.acquire();
+    const auto bytes = buffer.bytes().first(chunk.size + chunk.overlap);
+    if (options.limiter != nullptr) {
+      options.limiter->acquire(bytes.size());
+    }
+    const auto ranges =
+        read_resident_ranges(proc, pages ? &*pages : nullptr, chunk.begin,
+                             bytes, chunk.size, stats[worker]);
+    if (ranges) {
+      detail::hand_on_ranges(chunk, bytes, *ranges, fn, results[worker]);
+    }
+  });
+
+  if (options.stats != nullptr) {
+    *options.stats = {};
+    for (const auto &worker_stats : stats) {
+      options.stats->pages_read += worker_stats.pages_read;
+      options.stats->pages_skipped += worker_stats.pages_skipped;
+    }
+  }
+
+  std::size_t total{0};
+  for (const auto &result : results) {
+    total += result.size();
+  }
+  std::vector<R> merged{};
+  merged.reserve(total);
+  for (auto &result : results) {
+    merged.insert(merged.end(), std::make_move_iterator(result.begin()),
+                  std::make_move_iterator(result.end()));
+  }
+  return merged;
+}
+
+// addresses of every occurrence of pattern, sorted
+[[nodiscard]] std::vector<std::uintptr_t>
+search_memory(const process &proc, std::span<const memory_region> regions,
+              std::span<const std::byte> pattern,
+              const scan_options &options = {});
+
+// addresses of every match of sig, sorted
+[[nodiscard]] std::vector<std::uintptr_t>
+search_memory(const process &proc, std::span<const memory_region> regions,
+              const signature &sig, const scan_options &options = {});
+
+// every occurrence of every pattern in the set from a single pass over each
+// region, sorted by address
+[[nodiscard]] std::vector<pattern_match>
+search_memory(const process &proc, std::span<const memory_region> regions,
+              const pattern_set &patterns, const scan_options &options = {});
+
+// leftmost-longest, non overlapping matches of regex, sorted by address.
+// chunks overlap by regex.max_match_size() bytes.
+[[nodiscard]] std::vector<regex_match>
+search_memory(const process &proc, std::span<const memory_region> regions,
+              const byte_regex &regex, const scan_options &options = {});
+
+} // namespace pp
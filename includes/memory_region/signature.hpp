@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace pp {
+
+// ida style byte signature, e.g. "48 8B ?? ?? E8 ?? ?? ?? ??". "??" (or "?")
+// matches any byte, a single '?' nibble such as "4?" masks half of one.
+class signature {
+  // pattern bytes with the masked bits already cleared
+  std::vector<std::byte> bytes_{};
+  std::vector<std::byte> mask_{};
+  // longest run of fully fixed bytes, searched for first
+  std::size_t anchor_offset_{0};
+  std::size_t anchor_size_{0};
+
+public:
+  explicit signature(std::string_view pattern);
+  [[nodiscard]] std::size_t size() const noexcept;
+  // bytes has to hold at least size() bytes
+  [[nodiscard]] bool matches(std::span<const std::byte> bytes) const noexcept;
+  // offset of the first match, haystack.size() if there is none
+  [[nodiscard]] std::size_t
+  find(std::span<const std::byte> haystack) const noexcept;
+};
+
+} // namespace pp
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "memory_region/byte_search.hpp"
+#include "memory_region/memory_region.hpp"
+#include "memory_region/scanner.hpp"
+#include "process/process.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace pp {
+
+enum class string_encoding { ASCII, UTF16LE };
+
+struct strings_options {
+  // characters, not bytes
+  std::size_t min_length{4};
+  // also look for utf-16le runs next to the ascii ones
+  bool utf16{false};
+};
+
+struct string_run {
+  std::size_t offset{0};
+  // bytes, two per character for utf-16le
+  std::size_t size{0};
+  string_encoding encoding{string_encoding::ASCII};
+};
+
+// appends the printable runs of at least min_length characters in bytes,
+// sorted by offset. printable means 0x20-0x7e and tab, a utf-16le character
+// is a printable byte followed by a zero byte at either byte alignment. runs
+// reaching the end of bytes are cut there. bytes are classified 32 at a time
+// into bitmasks and runs are read off those masks.
+void find_strings(std::span<const std::byte> bytes,
+                  const strings_options &options,
+                  std::vector<string_run> &runs);
+
+// avx2 classifies with its own kernel, the others fall back to scalar
+void find_strings(std::span<const std::byte> bytes,
+                  const strings_options &options, std::vector<string_run> &runs,
+                  search_kernel kernel);
+
+struct found_string {
+  std::uintptr_t address{0};
+  string_encoding encoding{string_encoding::ASCII};
+  // utf-16le strings are narrowed to their ascii characters
+  std::string text{};
+};
+
+// scans regions on the parallel chunked reader and hands the strings of every
+// chunk to sink as soon as the chunk is done, so output can be streamed.
+// sink is called from the scan's worker threads, one chunk at a time per
+// thread, each batch sorted by address. strings crossing a chunk boundary
+// are cut 4 KB past it. returns the number of strings found.
+std::size_t
+scan_strings(const process &proc, std::span<const memory_region> regions,
+             const strings_options &strings,
+             const std::function<void(std::span<const found_string>)> &sink,
+             const scan_options &options = {});
+
+} // namespace pp
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <vector>
+
+namespace pp {
+
+// token bucket the readers of one or more scans share. a read takes its size
+// in bytes from the bucket and waits while the bucket is in debt, so all of
+// them together stay at the rate whatever the number of threads. the bucket
+// holds at most a tenth of a second of reads.
+class rate_limiter {
+  using clock = std::chrono::steady_clock;
+
+  mutable std::mutex mutex_{};
+  double max_rate_{0};
+  // bytes per second, lower than max_rate_ while backing off
+  double rate_{0};
+  double tokens_{0};
+  clock::time_point refilled_{};
+
+  // processes whose cpu use is watched, empty when not adapting
+  std::vector<std::uint32_t> targets_{};
+  clock::time_point sampled_{};
+  // cpu ticks of every target at the last sample
+  std::vector<std::uint64_t> target_ticks_{};
+  // the lowest cpu use of the targets seen so far, in cores
+  double baseline_{-1};
+
+  void adapt(clock::time_point now);
+
+public:
+  explicit rate_limiter(std::size_t bytes_per_second);
+
+  // from now on the rate is halved, down to a sixteenth, whenever the cpu use
+  // of the targets from /proc/<pid>/stat rises above the lowest it has been,
+  // and climbs back by an eighth while it stays there. checked every 250 ms.
+  // targets that exit are no longer watched, with none left the rate goes
+  // back to the full budget.
+  void adapt_to(std::span<const std::uint32_t> pids);
+
+  // blocks until size bytes may be read
+  void acquire(std::size_t size);
+  [[nodiscard]] std::size_t rate() const;
+};
+
+// SCHED_IDLE for the calling thread, nice 19 where that is not allowed.
+// threads it starts afterwards inherit it. without CAP_SYS_NICE it cannot be
+// undone, meant for a process that only scans from then on.
+void lower_priority();
+
+} // namespace pp
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <span>
+#include <system_error>
+
+namespace pp {
+
+// asynchronous reads of /proc/<id>/mem through an io_uring. add() queues an
+// IORING_OP_READ at the remote address, submit() hands every queued read to
+// the kernel in one io_uring_enter and wait() returns them as they complete,
+// in no particular order. up to depth() reads are queued or in flight at once.
+class uring_reader {
+  int mem_fd_{-1};
+  int ring_fd_{-1};
+  void *sq_ring_{nullptr};
+  std::size_t sq_ring_size_{0};
+  void *cq_ring_{nullptr};
+  std::size_t cq_ring_size_{0};
+  void *sqes_{nullptr};
+  std::size_t sqes_size_{0};
+  std::uint32_t *sq_tail_{nullptr};
+  std::uint32_t sq_mask_{0};
+  std::uint32_t *sq_array_{nullptr};
+  std::uint32_t *cq_head_{nullptr};
+  std::uint32_t *cq_tail_{nullptr};
+  std::uint32_t cq_mask_{0};
+  void *cqes_{nullptr};
+  std::size_t depth_{0};
+  std::size_t queued_{0};
+  std::size_t in_flight_{0};
+
+  void close() noexcept;
+
+public:
+  struct completion {
+    std::uint64_t tag{0};
+    // bytes read, short when the read ran into an unreadable page
+    std::expected<std::size_t, std::error_code> read{0};
+  };
+
+  explicit uring_reader(std::uint32_t id, std::size_t depth = 32);
+  uring_reader(const uring_reader &other) = delete;
+  uring_reader &operator=(const uring_reader &other) = delete;
+  uring_reader(uring_reader &&other) = delete;
+  uring_reader &operator=(uring_reader &&other) = delete;
+  ~uring_reader();
+
+  [[nodiscard]] std::size_t depth() const noexcept;
+  // reads queued or submitted that wait() has not returned yet
+  [[nodiscard]] std::size_t in_flight() const noexcept;
+  // out has to stay valid until wait() returns tag. throws std::length_error
+  // when depth() reads are already in flight.
+  void add(std::uint64_t tag, std::uintptr_t address, std::span<std::byte> out);
+  void submit();
+  // submits what is queued and blocks until a read completes
+  [[nodiscard]] completion wait();
+};
+
+} // namespace pp
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "memory_region/dirty_page_set.hpp"
+#include "memory_region/memory_region.hpp"
+#include "memory_region/scanner.hpp"
+#include "memory_region/value_search.hpp"
+#include "process/process.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace pp {
+
+enum class scan_filter { CHANGED, UNCHANGED, INCREASED, DECREASED, EQUAL };
+
+// cheat-engine style narrowing: the first scan collects every aligned value
+// in [low, high], later scans reread only the pages that still hold
+// candidates and keep those passing the filter. candidates are stored per page
+// as 16 bit page offsets next to the value last read there.
+template <typename T>
+  requires std::is_arithmetic_v<T>
+class scan_session {
+  struct candidate_page {
+    std::uintptr_t address{0};
+    // index of the first candidate of this page in offsets_ and values_
+    std::size_t begin{0};
+  };
+
+  process proc_;
+  std::optional<dirty_page_set> dirty_{};
+  std::vector<candidate_page> pages_{};
+  std::vector<std::uint16_t> offsets_{};
+  std::vector<T> values_{};
+  std::size_t pages_read_{0};
+
+  void add(std::uintptr_t address, T value);
+
+public:
+  // incremental sessions track soft-dirty bits and only reread pages that
+  // were written since the previous scan
+  explicit scan_session(const process &proc, bool incremental = false)
+      : proc_{proc} {
+    if (incremental) {
+      this->dirty_.emplace(proc);
+    }
+  }
+  void first_scan(std::span<const memory_region> regions, T low, T high,
+                  const scan_options &options = {});
+  // EQUAL keeps the values in [low, high], the others compare against the
+  // value of the previous scan
+  void next_scan(scan_filter filter, T low = {}, T high = {});
+  [[nodiscard]] std::size_t size() const noexcept;
+  [[nodiscard]] std::size_t page_count() const noexcept;
+  // pages the last scan had to read
+  [[nodiscard]] std::size_t pages_read() const noexcept;
+  [[nodiscard]] std::vector<value_candidate<T>>
+  candidates(std::size_t max_count) const;
+};
+
+} // namespace pp
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "memory_region/byte_search.hpp"
+#include "memory_region/memory_region.hpp"
+#include "memory_region/scanner.hpp"
+#include "process/process.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace pp {
+
+template <typename T> struct value_candidate {
+  std::uintptr_t address{0};
+  T value{};
+};
+
+// appends the offset of every value of T in bytes that lies in [low, high],
+// in increasing order. aligned only looks at multiples of sizeof(T), otherwise
+// every byte offset is a candidate. nan never matches.
+template <typename T>
+  requires std::is_arithmetic_v<T>
+void find_values(std::span<const std::byte> bytes, T low, T high, bool aligned,
+                 std::vector<std::size_t> &offsets);
+
+// avx2 has its own kernels, the others fall back to scalar compares
+template <typename T>
+  requires std::is_arithmetic_v<T>
+void find_values(std::span<const std::byte> bytes, T low, T high, bool aligned,
+                 std::vector<std::size_t> &offsets, search_kernel kernel);
+
+// every value of T in [low, high] with its address, sorted by address
+template <typename T>
+  requires std::is_arithmetic_v<T>
+[[nodiscard]] std::vector<value_candidate<T>>
+search_values(const process &proc, std::span<const memory_region> regions,
+              T low, T high, bool aligned, const scan_options &options = {});
+
+} // namespace pp
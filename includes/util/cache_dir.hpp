@@ -0,0 +1,10 @@
+#pragma once
+
+#include <filesystem>
+
+namespace pp {
+
+// $XDG_CACHE_HOME/pp, ~/.cache/pp without it
+[[nodiscard]] std::filesystem::path cache_dir();
+
+} // namespace pp
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+namespace pp {
+
+// fork-join pool: task indices are split into one contiguous range per worker,
+// idle workers steal the upper half of a busy worker's range.
+class work_stealing_pool {
+  std::size_t thread_count_{1};
+
+public:
+  explicit work_stealing_pool(std::size_t thread_count = 0);
+  [[nodiscard]] std::size_t size() const noexcept;
+  // blocks until every task ran, rethrows the first exception a task threw
+  void run(std::size_t task_count,
+           const std::function<void(std::size_t worker, std::size_t task)>
+               &task) const;
+};
+
+} // namespace pp
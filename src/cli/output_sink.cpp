@@ -0,0 +1,164 @@
+#include "cli/output_sink.hpp"
+
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace pp {
+
+namespace {
+
+static_assert(std::endian::native == std::endian::little,
+              "binary records are written in native byte order");
+
+std::atomic<output_format> current_format{output_format::TEXT};
+
+template <typename T> void append_raw(std::string &buffer, T value) {
+  const auto offset = buffer.size();
+  buffer.resize(offset + sizeof(value));
+  std::memcpy(buffer.data() + offset, &value, sizeof(value));
+}
+
+// u8 size and the bytes, longer keys and kinds are a programming error
+void append_short(std::string &buffer, std::string_view text) {
+  if (text.size() > std::numeric_limits<std::uint8_t>::max()) {
+    throw std::length_error("record key too long");
+  }
+  append_raw(buffer, static_cast<std::uint8_t>(text.size()));
+  buffer += text;
+}
+
+void append_json_string(std::string &buffer, std::string_view text) {
+  buffer += '"';
+  for (const auto c : text) {
+    switch (c) {
+    case '"':
+      buffer += "\\\"";
+      break;
+    case '\\':
+      buffer += "\\\\";
+      break;
+    case '\n':
+      buffer += "\\n";
+      break;
+    case '\t':
+      buffer += "\\t";
+      break;
+    default:
+      if (static_cast<unsigned char>(c) < 0x20) {
+        std::format_to(std::back_inserter(buffer), "\\u{:04x}",
+                       static_cast<unsigned char>(c));
+      } else {
+        buffer += c;
+      }
+    }
+  }
+  buffer += '"';
+}
+
+} // namespace
+
+[[nodiscard]] std::string_view output_format_to_str(output_format format) {
+  switch (format) {
+  case output_format::TEXT:
+    return "text";
+  case output_format::JSONL:
+    return "jsonl";
+  case output_format::BINARY:
+    return "binary";
+  }
+  throw std::invalid_argument("unknown output format");
+}
+
+[[nodiscard]] std::optional<output_format>
+str_to_output_format(std::string_view name) {
+  for (const auto format :
+       {output_format::TEXT, output_format::JSONL, output_format::BINARY}) {
+    if (output_format_to_str(format) == name) {
+      return format;
+    }
+  }
+  return std::nullopt;
+}
+
+[[nodiscard]] output_format active_output_format() noexcept {
+  return current_format.load(std::memory_order_relaxed);
+}
+
+void set_output_format(output_format format) noexcept {
+  current_format.store(format, std::memory_order_relaxed);
+}
+
+output_sink::output_sink(std::FILE *file, output_format format,
+                         std::size_t capacity)
+    : file_{file}, format_{format}, capacity_{capacity} {
+  this->buffer_.reserve(capacity + 4096);
+}
+
+output_sink::~output_sink() { this->flush(); }
+
+[[nodiscard]] output_format output_sink::format() const noexcept {
+  return this->format_;
+}
+
+void output_sink::write_json(std::string_view kind,
+                             std::initializer_list<field> fields) {
+  this->buffer_ += "{\"type\":";
+  append_json_string(this->buffer_, kind);
+  for (const auto &[key, value] : fields) {
+    this->buffer_ += ',';
+    append_json_string(this->buffer_, key);
+    this->buffer_ += ':';
+    if (const auto *number = std::get_if<std::uint64_t>(&value)) {
+      std::format_to(std::back_inserter(this->buffer_), "{}", *number);
+    } else if (const auto *address = std::get_if<hex>(&value)) {
+      std::format_to(std::back_inserter(this->buffer_), "\"0x{:x}\"",
+                     address->value);
+    } else {
+      append_json_string(this->buffer_, std::get<std::string_view>(value));
+    }
+  }
+  this->buffer_ += "}\n";
+}
+
+void output_sink::write_binary(std::string_view kind,
+                               std::initializer_list<field> fields) {
+  const auto start = this->buffer_.size();
+  append_raw(this->buffer_, std::uint32_t{0});
+  append_short(this->buffer_, kind);
+  append_raw(this->buffer_, static_cast<std::uint8_t>(fields.size()));
+  for (const auto &[key, value] : fields) {
+    append_short(this->buffer_, key);
+    append_raw(this->buffer_, static_cast<std::uint8_t>(value.index()));
+    if (const auto *number = std::get_if<std::uint64_t>(&value)) {
+      append_raw(this->buffer_, *number);
+    } else if (const auto *address = std::get_if<hex>(&value)) {
+      append_raw(this->buffer_, address->value);
+    } else {
+      const auto text = std::get<std::string_view>(value);
+      append_raw(this->buffer_, static_cast<std::uint32_t>(text.size()));
+      this->buffer_ += text;
+    }
+  }
+  const auto size =
+      static_cast<std::uint32_t>(this->buffer_.size() - start - 4);
+  std::memcpy(this->buffer_.data() + start, &size, sizeof(size));
+}
+
+void output_sink::flush_if_full() {
+  if (this->buffer_.size() >= this->capacity_) {
+    this->flush();
+  }
+}
+
+void output_sink::flush() {
+  if (!this->buffer_.empty()) {
+    std::fwrite(this->buffer_.data(), 1, this->buffer_.size(), this->file_);
+    this->buffer_.clear();
+  }
+  std::fflush(this->file_);
+}
+
+} // namespace pp
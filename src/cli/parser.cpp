@@ -1,21 +1,310 @@
 #include "cli/parser.hpp"
+#include "cli/output_sink.hpp"
 #include "debugger/debugger.hpp"
 #include "debugger/registers.hpp"
 #include "disassembler/disassembler.hpp"
+#include "disassembler/insn_search.hpp"
+#include "memory_region/backend_calibration.hpp"
+#include "memory_region/byte_regex.hpp"
+#include "memory_region/chunk_reader.hpp"
+#include "memory_region/dirty_page_set.hpp"
+#include "memory_region/fleet_scan.hpp"
 #include "memory_region/memio.hpp"
+#include "memory_region/memory_dump.hpp"
+#include "memory_region/numa.hpp"
+#include "memory_region/page_dedup.hpp"
+#include "memory_region/page_profile.hpp"
+#include "memory_region/pattern_set.hpp"
 #include "memory_region/permission.hpp"
+#include "memory_region/pointer_map.hpp"
+#include "memory_region/scanner.hpp"
+#include "memory_region/signature.hpp"
+#include "memory_region/string_scan.hpp"
+#include "memory_region/throttle.hpp"
+#include "memory_region/value_scan.hpp"
+#include "memory_region/value_search.hpp"
 #include "process/process.hpp"
 #include "util/addr_to_region.hpp"
 #include "util/demangle.hpp"
 #include "util/read_file.hpp"
 
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <mutex>
+#include <ranges>
+
 namespace pp {
+
+namespace {
+
+// ASCII strings are taken as is, hex patterns may contain whitespace
+[[nodiscard]] std::vector<std::byte> to_pattern_bytes(std::string_view text,
+                                                      bool string_mode) {
+  std::vector<std::byte> bytes;
+  if (string_mode) {
+    bytes.reserve(text.size());
+    for (char c : text) {
+      bytes.push_back(static_cast<std::byte>(c));
+    }
+    return bytes;
+  }
+  std::string hex;
+  std::ranges::copy_if(text, std::back_inserter(hex), [](char c) {
+    return !std::isspace(static_cast<unsigned char>(c));
+  });
+  if (hex.length() % 2 != 0) {
+    throw std::invalid_argument("Hex pattern must have even length");
+  }
+  for (size_t i = 0; i < hex.length(); i += 2) {
+    if (!std::isxdigit(hex[i]) || !std::isxdigit(hex[i + 1])) {
+      throw std::invalid_argument("Invalid hex character in pattern");
+    }
+    bytes.push_back(
+        static_cast<std::byte>(std::stoul(hex.substr(i, 2), nullptr, 16)));
+  }
+  return bytes;
+}
+
+void print_scan_stats(const pp::scan_stats &stats) {
+  std::println("Pages read: {}, skipped (not resident): {}", stats.pages_read,
+               stats.pages_skipped);
+}
+
+void print_scan_stats(pp::output_sink &out, const pp::scan_stats &stats) {
+  out.note("Pages read: {}, skipped (not resident): {}", stats.pages_read,
+           stats.pages_skipped);
+}
+
+// printable ASCII as is, everything else as \xhh
+[[nodiscard]] std::string escape_bytes(std::span<const std::byte> bytes) {
+  std::string text;
+  for (const auto byte : bytes) {
+    const auto c = std::to_integer<unsigned char>(byte);
+    if (std::isprint(c) != 0 && c != '\\') {
+      text += static_cast<char>(c);
+    } else {
+      text += std::format("\\x{:02x}", c);
+    }
+  }
+  return text;
+}
+
+template <typename T> [[nodiscard]] T parse_value(std::string_view text) {
+  T value{};
+  const auto *end = text.data() + text.size();
+  std::from_chars_result result{};
+  if constexpr (std::is_integral_v<T>) {
+    const bool is_hex = text.starts_with("0x") || text.starts_with("0X");
+    result = is_hex ? std::from_chars(text.data() + 2, end, value, 16)
+                    : std::from_chars(text.data(), end, value);
+  } else {
+    result = std::from_chars(text.data(), end, value);
+  }
+  if (result.ec != std::errc{} || result.ptr != end) {
+    throw std::invalid_argument(std::format("invalid value: {}", text));
+  }
+  return value;
+}
+
+// "value" or "low..high"
+template <typename T>
+[[nodiscard]] std::pair<T, T> parse_value_range(std::string_view text) {
+  if (const auto sep = text.find(".."); sep != std::string_view::npos) {
+    return {parse_value<T>(text.substr(0, sep)),
+            parse_value<T>(text.substr(sep + 2))};
+  }
+  const auto value = parse_value<T>(text);
+  return {value, value};
+}
+
+// calls fn(std::type_identity<T>{}) with the type named by name
+template <typename F> auto visit_value_type(std::string_view name, F &&fn) {
+  if (name == "i8") {
+    return fn(std::type_identity<std::int8_t>{});
+  } else if (name == "i16") {
+    return fn(std::type_identity<std::int16_t>{});
+  } else if (name == "i32") {
+    return fn(std::type_identity<std::int32_t>{});
+  } else if (name == "i64") {
+    return fn(std::type_identity<std::int64_t>{});
+  } else if (name == "u8") {
+    return fn(std::type_identity<std::uint8_t>{});
+  } else if (name == "u16") {
+    return fn(std::type_identity<std::uint16_t>{});
+  } else if (name == "u32") {
+    return fn(std::type_identity<std::uint32_t>{});
+  } else if (name == "u64") {
+    return fn(std::type_identity<std::uint64_t>{});
+  } else if (name == "f32") {
+    return fn(std::type_identity<float>{});
+  } else if (name == "f64") {
+    return fn(std::type_identity<double>{});
+  }
+  throw std::invalid_argument(std::format("unknown value type: {}", name));
+}
+
+// --budget <MB/s>, --max-cpu <cores> and --adaptive of the scanning commands
+struct throttle_args {
+  std::optional<std::size_t> budget{};
+  std::optional<std::size_t> max_cpu{};
+  bool adaptive{false};
+
+  // takes the option at args[i] and its value, false when it is none of them
+  [[nodiscard]] bool parse(std::span<const std::string_view> args,
+                           std::size_t &i) {
+    if (args[i] == "--budget" && i + 1 < args.size()) {
+      // 1 TB/s, far above what any backend reads and far below overflowing
+      // once turned into bytes
+      constexpr std::size_t max_budget = 1024 * 1024;
+      this->budget = parse_value<std::size_t>(args[++i]);
+      if (*this->budget == 0 || *this->budget > max_budget) {
+        throw std::invalid_argument(std::format(
+            "--budget must be between 1 and {} MB/s", max_budget));
+      }
+    } else if (args[i] == "--max-cpu" && i + 1 < args.size()) {
+      this->max_cpu = parse_value<std::size_t>(args[++i]);
+    } else if (args[i] == "--adaptive") {
+      this->adaptive = true;
+    } else {
+      return false;
+    }
+    return true;
+  }
+
+  // a throttled scan runs on at most max_cpu threads at idle priority and
+  // reads through limiter, which has to outlive it
+  void apply(std::span<const pp::process> targets,
+             std::optional<pp::rate_limiter> &limiter,
+             pp::scan_options &options) const {
+    if (this->adaptive && !this->budget) {
+      throw std::invalid_argument("--adaptive needs --budget");
+    }
+    if (!this->budget && !this->max_cpu) {
+      return;
+    }
+    if (this->max_cpu) {
+      options.threads = std::max<std::size_t>(*this->max_cpu, 1);
+    }
+    if (this->budget) {
+      const auto bytes_per_second = *this->budget * 1024 * 1024;
+      limiter.emplace(bytes_per_second);
+      // a chunk is charged to the limiter whole and then read at full speed,
+      // so chunks no larger than the bucket (a tenth of a second of budget)
+      // keep the reads as smooth as the bucket is, in whole pages
+      static const auto page_size =
+          static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+      options.chunk_size = std::clamp(
+          bytes_per_second / 10 / page_size * page_size, page_size,
+          std::max(options.chunk_size, page_size));
+      if (this->adaptive) {
+        std::vector<std::uint32_t> pids;
+        std::ranges::transform(targets, std::back_inserter(pids),
+                               &pp::process::pid);
+        limiter->adapt_to(pids);
+      }
+      options.limiter = &*limiter;
+    }
+    pp::lower_priority();
+  }
+};
+
+// the processes named by "<pid>" or "--name <comm>" in front of a command's
+// other arguments
+struct scan_targets {
+  std::vector<pp::process> processes{};
+  // arguments taken
+  std::size_t used{0};
+  std::string description{};
+
+  // what a result line starts with, nothing when there is one process
+  [[nodiscard]] std::string tag(std::uint32_t pid) const {
+    return this->processes.size() > 1 ? std::format("[{}] ", pid) : "";
+  }
+};
+
+[[nodiscard]] scan_targets
+parse_targets(std::span<const std::string_view> args) {
+  if (args.size() >= 2 && args[0] == "--name") {
+    auto processes = pp::find_process(args[1]);
+    auto description =
+        std::format("{} processes named '{}'", processes.size(), args[1]);
+    return {.processes = std::move(processes),
+            .used = 2,
+            .description = std::move(description)};
+  }
+  const auto pid = static_cast<std::uint32_t>(std::stoul(std::string{args[0]}));
+  const pp::process proc{pid};
+  return {.processes = {proc},
+          .used = 1,
+          .description = std::format("process {} ({})", pid, proc.name())};
+}
+
+// the dirty ranges of an incremental search, sorted by address, with overlap
+// bytes of the clean pages after them so matches starting in a dirty page and
+// running past it are still found. a range is clamped to the region it was
+// cut from and merged with the next one when they overlap.
+[[nodiscard]] std::vector<pp::memory_region>
+extend_ranges(std::span<const pp::memory_region> dirty,
+              std::span<const pp::memory_region> regions,
+              std::size_t overlap) {
+  std::vector<pp::memory_region> extended;
+  for (const auto &range : dirty) {
+    const auto &region = *std::prev(std::ranges::upper_bound(
+        regions, range.begin(), {}, &pp::memory_region::begin));
+    const auto region_end = region.begin() + region.size();
+    const auto end =
+        std::min(range.begin() + range.size() + overlap, region_end);
+    if (!extended.empty() &&
+        range.begin() < extended.back().begin() + extended.back().size()) {
+      const auto begin = extended.back().begin();
+      extended.back() = {begin, end - begin, range.permissions(),
+                         range.name()};
+    } else {
+      extended.emplace_back(range.begin(), end - range.begin(),
+                            range.permissions(), range.name());
+    }
+  }
+  return extended;
+}
+
+// whether address is inside one of ranges, sorted by address
+[[nodiscard]] bool starts_in(std::span<const pp::memory_region> ranges,
+                             std::uintptr_t address) {
+  const auto next = std::ranges::upper_bound(ranges, address, {},
+                                             &pp::memory_region::begin);
+  return next != ranges.begin() &&
+         address < std::prev(next)->begin() + std::prev(next)->size();
+}
+
+// hands print(tag, pid, value) what every scan that worked returned. failed
+// scans are reported on stderr, or rethrown when there is one process so it
+// fails the way it did before several could be scanned
+template <typename T, typename F>
+void print_results(const scan_targets &targets,
+                   const std::vector<pp::fleet_result<T>> &results, F &&print) {
+  for (const auto &result : results) {
+    if (!result.result) {
+      if (targets.processes.size() == 1) {
+        throw std::runtime_error(result.result.error());
+      }
+      std::println(stderr, "[{}] {}", result.pid, result.result.error());
+      continue;
+    }
+    print(targets.tag(result.pid), result.pid, *result.result);
+  }
+}
+
+} // namespace
+
 void cli_parser::add_command(command cmd) {
   this->commands[cmd.name] = std::move(cmd);
 }
 
 void cli_parser::print_usage() const {
-  std::println("usage: pp <command> [args...]\n");
+  std::println("usage: pp <command> [args...] [--format text|jsonl|binary]\n");
   std::println("available commands:");
   for (const auto &[name, cmd] : commands) {
     std::println("  {:<15} {}", name, cmd.description);
@@ -331,30 +620,27 @@ void load_commands(cli_parser &parser) {
            const auto memory = pp::read_memory_region(proc, region);
 
            // Print in hex + ASCII format
-           std::println("Memory at 0x{:x} (size: {} bytes):", addr, size);
+           pp::output_sink out;
+           out.note("Memory at 0x{:x} (size: {} bytes):", addr, size);
+           std::string hex;
+           std::string ascii;
            for (size_t i = 0; i < memory.size(); i += 16) {
-             // Address
-             std::print("0x{:016x}  ", addr + i);
-
-             // Hex values
-             for (size_t j = i; j < std::min(i + 16, memory.size()); ++j) {
-               std::print("{:02x} ", static_cast<unsigned char>(memory[j]));
-             }
-
-             // Padding for incomplete lines
-             if (memory.size() - i < 16) {
-               for (size_t j = 0; j < 16 - (memory.size() - i); ++j) {
-                 std::print("   ");
-               }
-             }
-
-             // ASCII representation
-             std::print(" |");
+             hex.clear();
+             ascii.clear();
              for (size_t j = i; j < std::min(i + 16, memory.size()); ++j) {
+               std::format_to(std::back_inserter(hex), "{:02x} ",
+                              static_cast<unsigned char>(memory[j]));
                char c = static_cast<char>(memory[j]);
-               std::print("{}", std::isprint(c) ? c : '.');
+               ascii += std::isprint(c) ? c : '.';
              }
-             std::println("|");
+             // Lines are records of their own, the bytes without the
+             // separator after the last one
+             const std::string_view bytes{hex.data(), hex.size() - 1};
+             out.record("line",
+                        {{"address", pp::hex{addr + i}},
+                         {"bytes", bytes},
+                         {"ascii", ascii}},
+                        "0x{:016x}  {:<48} |{}|", addr + i, hex, ascii);
            }
 
            return {};
@@ -406,18 +692,24 @@ void load_commands(cli_parser &parser) {
       {.name = "replace",
        .description = "find and replace pattern in process memory",
        .args = {"<pid>", "<find_pattern>", "<replace_pattern>", "[occurrences]",
-                "[--hex]"},
+                "[--hex]", "[--dry-run]"},
        .handler = [](std::span<const std::string_view> args)
            -> std::expected<void, std::string> {
          if (args.size() < 3) {
-           return std::unexpected{"Usage: replace <pid> <find_pattern> "
-                                  "<replace_pattern> [occurrences] [--hex]"};
+           return std::unexpected{
+               "Usage: replace <pid> <find_pattern> <replace_pattern> "
+               "[occurrences] [--hex] [--dry-run]"};
          }
 
          try {
            const auto pid =
                static_cast<std::uint32_t>(std::stoul(std::string{args[0]}));
-           const bool is_hex = args.size() > 3 && args[3] == "--hex";
+           const auto has_flag = [&args](std::string_view flag) {
+             return std::ranges::find(args.subspan(3), flag) !=
+                    args.subspan(3).end();
+           };
+           const bool is_hex = has_flag("--hex");
+           const bool dry_run = has_flag("--dry-run");
 
            // Convert pattern to bytes
            auto to_bytes =
@@ -448,34 +740,55 @@ void load_commands(cli_parser &parser) {
            }
 
            std::optional<std::size_t> occurrences;
-           if (args.size() > 3 && args[3] != "--hex") {
+           if (args.size() > 3 && !args[3].starts_with("--")) {
              occurrences = std::stoull(std::string{args[3]});
            }
 
            pp::process proc{pid};
-           size_t total_replacements = 0;
 
            // Search through all readable and writable regions
-           for (const auto &region : proc.memory_regions()) {
-             if (region.has_permissions(pp::permission::READ |
-                                        pp::permission::WRITE)) {
-               try {
-                 pp::replace_memory(proc, region, find_pattern, replace_pattern,
-                                    occurrences);
-                 if (occurrences) {
-                   total_replacements += *occurrences;
-                 }
-               } catch (...) {
-                 // Skip regions we can't access
-                 continue;
-               }
+           std::vector<pp::memory_region> regions;
+           std::ranges::copy_if(proc.memory_regions(),
+                                std::back_inserter(regions),
+                                [](const pp::memory_region &region) {
+                                  return region.has_permissions(
+                                      pp::permission::READ |
+                                      pp::permission::WRITE);
+                                });
+
+           // Every match has to be replaced, swapped out pages included
+           std::vector<std::uintptr_t> addresses;
+           std::uintptr_t next_free = 0;
+           for (const auto address :
+                pp::search_memory(proc, regions, find_pattern,
+                                  {.include_swapped = true})) {
+             if (occurrences && addresses.size() >= *occurrences) {
+               break;
+             }
+             // Don't patch over a match we're already replacing
+             if (address < next_free) {
+               continue;
              }
+             addresses.push_back(address);
+             next_free = address + replace_pattern.size();
            }
 
-           std::println("Successfully replaced pattern in process {}", pid);
-           if (occurrences) {
-             std::println("Replacements made: {}", total_replacements);
+           // Only the patched bytes are written, in one batch
+           const auto result = pp::write_patches(
+               proc, addresses, replace_pattern, dry_run);
+           if (dry_run) {
+             for (const auto address : result.patches) {
+               std::println("  0x{:x}: {} bytes", address,
+                            replace_pattern.size());
+             }
+             std::println("Would replace {} occurrences ({} bytes) in "
+                          "process {}",
+                          result.patches.size(), result.bytes, pid);
+             return {};
            }
+           std::println("Successfully replaced pattern in process {}", pid);
+           std::println("Replacements made: {} ({} bytes)",
+                        result.patches.size(), result.bytes);
            return {};
          } catch (const std::exception &e) {
            return std::unexpected{
@@ -486,86 +799,701 @@ void load_commands(cli_parser &parser) {
   parser.add_command(
       {.name = "search",
        .description = "search for pattern (hex or string) in memory regions",
-       .args = {"<pid>", "<pattern>", "[--string|-s]"},
+       .args = {"<pid>|--name <comm>",
+                "<pattern>|--patterns <file>|--regex <expr>", "[--string|-s]",
+                "[--include-swapped]", "[--incremental]", "[--budget <MB/s>]",
+                "[--max-cpu <cores>]", "[--adaptive]"},
        .handler = [](std::span<const std::string_view> args)
            -> std::expected<void, std::string> {
          if (args.size() < 2) {
            return std::unexpected{
-               "Usage: search <pid> <pattern> [--string|-s]"};
+               "Usage: search <pid>|--name <comm> <pattern>|--patterns "
+               "<file>|--regex <expr> [--string|-s] [--include-swapped] "
+               "[--incremental] [--budget <MB/s>] [--max-cpu <cores>] "
+               "[--adaptive]"};
          }
          try {
-           const auto pid =
-               static_cast<std::uint32_t>(std::stoul(std::string{args[0]}));
-
-           // Check if string mode is enabled
-           const bool string_mode =
-               args.size() > 2 && (args[2] == "--string" || args[2] == "-s");
-
-           std::vector<std::byte> pattern;
-           if (string_mode) {
-             // Convert ASCII string to bytes
-             const auto &str = args[1];
-             pattern.reserve(str.size());
-             for (char c : str) {
-               pattern.push_back(static_cast<std::byte>(c));
+           const auto targets = parse_targets(args);
+
+           bool string_mode = false;
+           bool incremental = false;
+           std::optional<std::string_view> patterns_file;
+           std::optional<std::string_view> regex;
+           pp::scan_stats stats;
+           pp::scan_options options{.stats = &stats};
+           std::string_view pattern_arg;
+           throttle_args throttle;
+           for (std::size_t i = targets.used; i < args.size(); ++i) {
+             if (throttle.parse(args, i)) {
+               continue;
              }
-           } else {
-             auto hex_to_bytes = [](std::string_view hex) {
-               std::vector<std::byte> bytes;
-               if (hex.length() % 2 != 0) {
-                 throw std::invalid_argument(
-                     "Hex pattern must have even length");
-               }
-               for (size_t i = 0; i < hex.length(); i += 2) {
-                 if (!std::isxdigit(hex[i]) || !std::isxdigit(hex[i + 1])) {
-                   throw std::invalid_argument(
-                       "Invalid hex character in pattern");
-                 }
-                 bytes.push_back(static_cast<std::byte>(
-                     std::stoul(std::string{hex.substr(i, 2)}, nullptr, 16)));
+             if (args[i] == "--string" || args[i] == "-s") {
+               string_mode = true;
+             } else if (args[i] == "--include-swapped") {
+               options.include_swapped = true;
+             } else if (args[i] == "--incremental") {
+               incremental = true;
+             } else if (args[i] == "--patterns" && i + 1 < args.size()) {
+               patterns_file = args[++i];
+             } else if (args[i] == "--regex" && i + 1 < args.size()) {
+               regex = args[++i];
+             } else {
+               pattern_arg = args[i];
+             }
+           }
+           std::optional<pp::rate_limiter> limiter;
+           throttle.apply(targets.processes, limiter, options);
+           pp::output_sink out;
+
+           // Runs search on the readable regions of proc and returns its
+           // matches, address_of(match) is where one starts
+           const auto search_regions = [&targets, &out, incremental](
+                                           const pp::process &proc,
+                                           std::size_t overlap,
+                                           const auto &search,
+                                           const auto &address_of) {
+             std::vector<pp::memory_region> regions;
+             std::ranges::copy_if(proc.memory_regions(),
+                                  std::back_inserter(regions),
+                                  [](const pp::memory_region &region) {
+                                    return region.has_permissions(
+                                        pp::permission::READ);
+                                  });
+             if (!incremental) {
+               return search(regions);
+             }
+             // Only pages written since the previous incremental search are
+             // read, the soft-dirty bits are cleared again before reading.
+             // Matches may run overlap bytes into the clean pages after them
+             // but have to start in a dirty one.
+             const pp::dirty_page_set dirty_pages{proc};
+             const auto dirty = dirty_pages.take_dirty_regions(regions);
+             std::println(out.format() == pp::output_format::TEXT ? stdout
+                                                                  : stderr,
+                          "{}Searching {} dirty ranges",
+                          targets.tag(proc.pid()), dirty.size());
+             auto matches = search(extend_ranges(dirty, regions, overlap));
+             std::erase_if(matches, [&](const auto &match) {
+               return !starts_in(dirty, std::invoke(address_of, match));
+             });
+             return matches;
+           };
+
+           if (regex) {
+             const pp::byte_regex compiled{*regex};
+             out.note("Searching for regex '{}' in {}:", *regex,
+                      targets.description);
+             out.flush();
+
+             const auto results = pp::scan_fleet(
+                 targets.processes, options,
+                 [&](const pp::process &proc, const pp::scan_options &scan) {
+                   return search_regions(
+                       proc, compiled.max_match_size(),
+                       [&](std::span<const pp::memory_region> regions) {
+                         return pp::search_memory(proc, regions, compiled,
+                                                  scan);
+                       },
+                       &pp::regex_match::address);
+                 });
+             std::size_t total = 0;
+             std::vector<std::byte> bytes;
+             print_results(targets, results,
+                           [&](const std::string &tag, std::uint32_t pid,
+                               const auto &matches) {
+                             const pp::process proc{pid};
+                             for (const auto &match : matches) {
+                               // Show at most 64 bytes of every match, what
+                               // is still readable of them once the scan is
+                               // done
+                               bytes.resize(
+                                   std::min<std::size_t>(match.size, 64));
+                               const auto read = pp::try_read_memory(
+                                   proc, match.address, bytes);
+                               bytes.resize(read ? *read : 0);
+                               const auto shown = escape_bytes(bytes);
+                               out.record(
+                                   "match",
+                                   {{"pid", pid},
+                                    {"address", pp::hex{match.address}},
+                                    {"size", match.size},
+                                    {"bytes", shown}},
+                                   "{}Found at: 0x{:x} ({} bytes): {}{}", tag,
+                                   match.address, match.size, shown,
+                                   match.size > bytes.size() ? "..." : "");
+                             }
+                             total += matches.size();
+                           });
+
+             out.note("Total matches found: {}", total);
+             print_scan_stats(out, stats);
+             return {};
+           }
+
+           if (patterns_file) {
+             // One pattern per line, blank lines and '#' comments are skipped
+             std::vector<std::vector<std::byte>> patterns;
+             std::istringstream lines{pp::read_file(*patterns_file)};
+             std::string line;
+             while (std::getline(lines, line)) {
+               if (line.empty() || line.starts_with('#')) {
+                 continue;
                }
-               return bytes;
-             };
-             pattern = hex_to_bytes(args[1]);
+               patterns.push_back(to_pattern_bytes(line, string_mode));
+             }
+             const pp::pattern_set set{patterns};
+
+             out.note("Searching for {} {} patterns from '{}' in {}:",
+                      set.size(), string_mode ? "string" : "hex",
+                      *patterns_file, targets.description);
+             out.flush();
+
+             const auto results = pp::scan_fleet(
+                 targets.processes, options,
+                 [&](const pp::process &proc, const pp::scan_options &scan) {
+                   return search_regions(
+                       proc, set.max_pattern_size() - 1,
+                       [&](std::span<const pp::memory_region> regions) {
+                         return pp::search_memory(proc, regions, set, scan);
+                       },
+                       &pp::pattern_match::address);
+                 });
+             std::size_t total = 0;
+             print_results(targets, results,
+                           [&](const std::string &tag, std::uint32_t pid,
+                               const auto &matches) {
+                             for (const auto &match : matches) {
+                               out.record(
+                                   "match",
+                                   {{"pid", pid},
+                                    {"address", pp::hex{match.address}},
+                                    {"pattern", match.pattern}},
+                                   "{}Found pattern {} at: 0x{:x}", tag,
+                                   match.pattern, match.address);
+                             }
+                             total += matches.size();
+                           });
+
+             out.note("Total matches found: {}", total);
+             print_scan_stats(out, stats);
+             return {};
            }
 
+           const auto pattern = to_pattern_bytes(pattern_arg, string_mode);
            if (pattern.empty()) {
              return std::unexpected{"Pattern cannot be empty"};
            }
 
+           out.note("Searching for {} pattern '{}' in {}:",
+                    string_mode ? "string" : "hex", pattern_arg,
+                    targets.description);
+           out.flush();
+
+           const auto results = pp::scan_fleet(
+               targets.processes, options,
+               [&](const pp::process &proc, const pp::scan_options &scan) {
+                 return search_regions(
+                     proc, pattern.size() - 1,
+                     [&](std::span<const pp::memory_region> regions) {
+                       return pp::search_memory(proc, regions, pattern, scan);
+                     },
+                     std::identity{});
+               });
+           std::size_t total = 0;
+           print_results(targets, results,
+                         [&](const std::string &tag, std::uint32_t pid,
+                             const auto &matches) {
+                           for (const auto address : matches) {
+                             out.record("match",
+                                        {{"pid", pid},
+                                         {"address", pp::hex{address}}},
+                                        "{}Found at: 0x{:x}", tag, address);
+                           }
+                           total += matches.size();
+                         });
+
+           out.note("Total matches found: {}", total);
+           print_scan_stats(out, stats);
+           return {};
+         } catch (const std::exception &e) {
+           return std::unexpected{
+               std::format("Error searching memory: {}", e.what())};
+         }
+       }});
+
+  parser.add_command(
+      {.name = "sigscan",
+       .description = "search for an ida style signature in memory regions",
+       .args = {"<pid>|--name <comm>", "<signature>", "[--exec-only]",
+                "[--include-swapped]", "[--budget <MB/s>]",
+                "[--max-cpu <cores>]", "[--adaptive]"},
+       .handler = [](std::span<const std::string_view> args)
+           -> std::expected<void, std::string> {
+         if (args.size() < 2) {
+           return std::unexpected{
+               "Usage: sigscan <pid>|--name <comm> <signature> [--exec-only] "
+               "[--include-swapped] [--budget <MB/s>] [--max-cpu <cores>] "
+               "[--adaptive]"};
+         }
+         try {
+           const auto targets = parse_targets(args);
+
+           // The signature may be quoted or passed as separate bytes
+           bool exec_only = false;
+           pp::scan_stats stats;
+           pp::scan_options options{.stats = &stats};
+           std::string pattern;
+           throttle_args throttle;
+           for (std::size_t i = targets.used; i < args.size(); ++i) {
+             if (throttle.parse(args, i)) {
+               continue;
+             }
+             if (args[i] == "--exec-only") {
+               exec_only = true;
+             } else if (args[i] == "--include-swapped") {
+               options.include_swapped = true;
+             } else {
+               pattern += std::string{args[i]} + " ";
+             }
+           }
+           const pp::signature sig{pattern};
+           std::optional<pp::rate_limiter> limiter;
+           throttle.apply(targets.processes, limiter, options);
+
+           std::println("Scanning for signature '{}' in {}:", pattern,
+                        targets.description);
+
+           const auto results = pp::scan_fleet(
+               targets.processes, options,
+               [&](const pp::process &proc, const pp::scan_options &scan) {
+                 std::vector<pp::memory_region> regions;
+                 std::ranges::copy_if(
+                     proc.memory_regions(), std::back_inserter(regions),
+                     [exec_only](const pp::memory_region &region) {
+                       return region.has_permissions(pp::permission::READ) &&
+                              (!exec_only ||
+                               region.has_permissions(
+                                   pp::permission::EXECUTE));
+                     });
+                 auto matches = pp::search_memory(proc, regions, sig, scan);
+                 return std::pair{std::move(regions), std::move(matches)};
+               });
+           std::size_t total = 0;
+           print_results(
+               targets, results,
+               [&total](const std::string &tag, std::uint32_t,
+                        const auto &found) {
+                 const auto &[regions, matches] = found;
+                 auto region = regions.cbegin();
+                 for (const auto address : matches) {
+                   while (address >= region->begin() + region->size()) {
+                     ++region;
+                   }
+                   std::println("{}Found at: 0x{:x} ({}+0x{:x})", tag, address,
+                                region->name().value_or("[anonymous]"),
+                                address - region->begin());
+                 }
+                 total += matches.size();
+               });
+
+           std::println("Total matches found: {}", total);
+           print_scan_stats(stats);
+           return {};
+         } catch (const std::exception &e) {
+           return std::unexpected{
+               std::format("Error scanning for signature: {}", e.what())};
+         }
+       }});
+
+  parser.add_command(
+      {.name = "scan",
+       .description = "scan memory for numeric values equal to or within a "
+                      "range",
+       .args = {"<pid>", "--type <i8|i16|i32|i64|u8|u16|u32|u64|f32|f64>",
+                "--eq <value> [--epsilon <e>]|--range <low> <high>",
+                "[--aligned]", "[--include-swapped]", "[--budget <MB/s>]",
+                "[--max-cpu <cores>]", "[--adaptive]"},
+       .handler = [](std::span<const std::string_view> args)
+           -> std::expected<void, std::string> {
+         constexpr auto usage =
+             "Usage: scan <pid> --type <type> --eq <value> [--epsilon <e>]|"
+             "--range <low> <high> [--aligned] [--include-swapped] "
+             "[--budget <MB/s>] [--max-cpu <cores>] [--adaptive]";
+         if (args.size() < 4) {
+           return std::unexpected{usage};
+         }
+         try {
+           const auto pid =
+               static_cast<std::uint32_t>(std::stoul(std::string{args[0]}));
+
+           std::string_view type;
+           std::optional<std::string_view> eq;
+           std::optional<std::string_view> epsilon;
+           std::optional<std::pair<std::string_view, std::string_view>> range;
+           bool aligned = false;
+           pp::scan_stats stats;
+           pp::scan_options options{.stats = &stats};
+           throttle_args throttle;
+           for (std::size_t i = 1; i < args.size(); ++i) {
+             if (throttle.parse(args, i)) {
+               continue;
+             }
+             if (args[i] == "--type" && i + 1 < args.size()) {
+               type = args[++i];
+             } else if (args[i] == "--eq" && i + 1 < args.size()) {
+               eq = args[++i];
+             } else if (args[i] == "--epsilon" && i + 1 < args.size()) {
+               epsilon = args[++i];
+             } else if (args[i] == "--range" && i + 2 < args.size()) {
+               range = {args[i + 1], args[i + 2]};
+               i += 2;
+             } else if (args[i] == "--aligned") {
+               aligned = true;
+             } else if (args[i] == "--include-swapped") {
+               options.include_swapped = true;
+             } else {
+               return std::unexpected{usage};
+             }
+           }
+           if (type.empty() || eq.has_value() == range.has_value()) {
+             return std::unexpected{usage};
+           }
+
            pp::process proc{pid};
-           std::println("Searching for {} pattern '{}' in process {} ({}):",
-                        string_mode ? "string" : "hex", args[1], pid,
-                        proc.name());
+           std::optional<pp::rate_limiter> limiter;
+           throttle.apply(std::span{&proc, 1}, limiter, options);
+           std::vector<pp::memory_region> regions;
+           std::ranges::copy_if(proc.memory_regions(),
+                                std::back_inserter(regions),
+                                [](const pp::memory_region &region) {
+                                  return region.has_permissions(
+                                      pp::permission::READ);
+                                });
+
+           visit_value_type(type, [&]<typename T>(std::type_identity<T>) {
+             T low{};
+             T high{};
+             if (range) {
+               low = parse_value<T>(range->first);
+               high = parse_value<T>(range->second);
+             } else {
+               low = high = parse_value<T>(*eq);
+             }
+             if (epsilon) {
+               if constexpr (std::is_floating_point_v<T>) {
+                 const auto tolerance = std::abs(parse_value<T>(*epsilon));
+                 low -= tolerance;
+                 high += tolerance;
+               } else {
+                 throw std::invalid_argument(
+                     "--epsilon only applies to f32 and f64");
+               }
+             }
 
-           size_t total_matches = 0;
-           for (const auto &region : proc.memory_regions()) {
-             if (region.has_permissions(pp::permission::READ)) {
+             std::println("Scanning process {} ({}) for {} values in [{}, {}]"
+                          "{}:",
+                          pid, proc.name(), type, low, high,
+                          aligned ? ", aligned" : "");
+             const auto matches =
+                 pp::search_values(proc, regions, low, high, aligned, options);
+             for (const auto &match : matches) {
+               std::println("Found at: 0x{:x} = {}", match.address,
+                            match.value);
+             }
+             std::println("Total matches found: {}", matches.size());
+             print_scan_stats(stats);
+           });
+           return {};
+         } catch (const std::exception &e) {
+           return std::unexpected{
+               std::format("Error scanning values: {}", e.what())};
+         }
+       }});
+
+  parser.add_command(
+      {.name = "value-scan",
+       .description = "scan for a value and narrow the candidates "
+                      "interactively",
+       .args = {"<pid>", "<i8|i16|i32|i64|u8|u16|u32|u64|f32|f64>",
+                "<value|low..high>", "[--incremental]"},
+       .handler = [](std::span<const std::string_view> args)
+           -> std::expected<void, std::string> {
+         if (args.size() < 3) {
+           return std::unexpected{
+               "Usage: value-scan <pid> <type> <value|low..high> "
+               "[--incremental]"};
+         }
+         try {
+           const auto pid =
+               static_cast<std::uint32_t>(std::stoul(std::string{args[0]}));
+           pp::process proc{pid};
+
+           std::vector<pp::memory_region> regions;
+           std::ranges::copy_if(proc.memory_regions(),
+                                std::back_inserter(regions),
+                                [](const pp::memory_region &region) {
+                                  return region.has_permissions(
+                                      pp::permission::READ |
+                                      pp::permission::WRITE);
+                                });
+
+           visit_value_type(args[1], [&]<typename T>(std::type_identity<T>) {
+             const bool incremental =
+                 args.size() > 3 && args[3] == "--incremental";
+             pp::scan_session<T> session{proc, incremental};
+             const auto [low, high] = parse_value_range<T>(args[2]);
+             session.first_scan(regions, low, high);
+
+             const auto print_count = [&session] {
+               std::println("{} candidates on {} pages ({} pages read)",
+                            session.size(), session.page_count(),
+                            session.pages_read());
+             };
+             print_count();
+             std::println("commands: changed, unchanged, increased, "
+                          "decreased, eq <value|low..high>, list [n], quit");
+
+             std::string line;
+             while (true) {
+               std::print("> ");
+               std::fflush(stdout);
+               if (!std::getline(std::cin, line)) {
+                 break;
+               }
+               std::istringstream iss{line};
+               std::string command;
+               std::string operand;
+               iss >> command >> operand;
                try {
-                 const auto memory = pp::read_memory_region(proc, region);
-                 // Search for pattern in this region
-                 auto it = std::search(memory.begin(), memory.end(),
-                                       pattern.begin(), pattern.end());
-                 while (it != memory.end()) {
-                   const auto offset = std::distance(memory.begin(), it);
-                   std::println("Found at: 0x{:x}",
-                                region.begin() +
-                                    static_cast<std::size_t>(offset));
-                   total_matches++;
-                   it = std::search(it + 1, memory.end(), pattern.begin(),
-                                    pattern.end());
+                 if (command == "changed") {
+                   session.next_scan(pp::scan_filter::CHANGED);
+                 } else if (command == "unchanged") {
+                   session.next_scan(pp::scan_filter::UNCHANGED);
+                 } else if (command == "increased") {
+                   session.next_scan(pp::scan_filter::INCREASED);
+                 } else if (command == "decreased") {
+                   session.next_scan(pp::scan_filter::DECREASED);
+                 } else if (command == "eq") {
+                   const auto [eq_low, eq_high] =
+                       parse_value_range<T>(operand);
+                   session.next_scan(pp::scan_filter::EQUAL, eq_low, eq_high);
+                 } else if (command == "list") {
+                   const auto count =
+                       operand.empty() ? 20 : std::stoull(operand);
+                   for (const auto &candidate : session.candidates(count)) {
+                     std::println("0x{:x} = {}", candidate.address,
+                                  candidate.value);
+                   }
+                   continue;
+                 } else if (command == "quit" || command == "q") {
+                   break;
+                 } else if (!command.empty()) {
+                   std::println("unknown command: {}", command);
+                   continue;
+                 } else {
+                   continue;
                  }
-               } catch (...) {
+               } catch (const std::invalid_argument &e) {
+                 std::println("{}", e.what());
                  continue;
                }
+               print_count();
+             }
+           });
+           return {};
+         } catch (const std::exception &e) {
+           return std::unexpected{
+               std::format("Error scanning values: {}", e.what())};
+         }
+       }});
+
+  parser.add_command(
+      {.name = "pointer-map",
+       .description = "save every pointer of a process to a file for "
+                      "pointer-scan",
+       .args = {"<pid>", "<file>"},
+       .handler = [](std::span<const std::string_view> args)
+           -> std::expected<void, std::string> {
+         if (args.size() < 2) {
+           return std::unexpected{"Usage: pointer-map <pid> <file>"};
+         }
+         try {
+           const auto pid =
+               static_cast<std::uint32_t>(std::stoul(std::string{args[0]}));
+           const pp::process proc{pid};
+           const auto map = pp::pointer_map::build(proc);
+           map.save(std::filesystem::path{args[1]});
+           std::println("Saved {} pointers and {} module regions of {} to {}",
+                        map.entries().size(), map.modules().size(), pid,
+                        args[1]);
+           return {};
+         } catch (const std::exception &e) {
+           return std::unexpected{
+               std::format("Error building pointer map: {}", e.what())};
+         }
+       }});
+
+  parser.add_command(
+      {.name = "pointer-scan",
+       .description = "find module+offset pointer chains that lead to an "
+                      "address",
+       .args = {"<pid>|<map file>", "<address>", "[--depth <n>]",
+                "[--max-offset <n>]", "[--and <map file> <address>]..."},
+       .handler = [](std::span<const std::string_view> args)
+           -> std::expected<void, std::string> {
+         if (args.size() < 2) {
+           return std::unexpected{
+               "Usage: pointer-scan <pid>|<map file> <address> [--depth <n>] "
+               "[--max-offset <n>] [--and <map file> <address>]..."};
+         }
+         try {
+           // a pid is scanned now, anything else is a saved pointer-map
+           const auto open_map = [](std::string_view source) {
+             if (std::ranges::all_of(source, [](unsigned char c) {
+                   return std::isdigit(c) != 0;
+                 })) {
+               const pp::process proc{static_cast<std::uint32_t>(
+                   std::stoul(std::string{source}))};
+               return pp::pointer_map::build(proc);
+             }
+             return pp::pointer_map::load(std::filesystem::path{source});
+           };
+
+           pp::chain_options options{};
+           std::vector<std::pair<std::string_view, std::uintptr_t>> others;
+           for (std::size_t i = 2; i < args.size(); ++i) {
+             if (args[i] == "--depth" && i + 1 < args.size()) {
+               options.max_depth = parse_value<std::size_t>(args[++i]);
+             } else if (args[i] == "--max-offset" && i + 1 < args.size()) {
+               options.max_offset = parse_value<std::size_t>(args[++i]);
+             } else if (args[i] == "--and" && i + 2 < args.size()) {
+               others.emplace_back(args[i + 1],
+                                   parse_value<std::uintptr_t>(args[i + 2]));
+               i += 2;
+             } else {
+               return std::unexpected{
+                   std::format("Unknown argument: {}", args[i])};
              }
            }
 
-           std::println("Total matches found: {}", total_matches);
+           const auto target = parse_value<std::uintptr_t>(args[1]);
+           auto chains = pp::find_pointer_chains(open_map(args[0]), target,
+                                                 options);
+           std::println("{} chains to 0x{:x}", chains.size(), target);
+           // chains also found for the same value in other runs survive
+           // restarts
+           for (const auto &[file, address] : others) {
+             const auto other = pp::find_pointer_chains(
+                 pp::pointer_map::load(std::filesystem::path{file}), address,
+                 options);
+             chains = pp::intersect_chains(chains, other);
+             std::println("{} chains left after {} (0x{:x})", chains.size(),
+                          file, address);
+           }
+
+           for (const auto &chain : chains) {
+             std::string text = std::format(
+                 "{}+0x{:x}",
+                 std::filesystem::path{chain.module}.filename().string(),
+                 chain.offset);
+             for (const auto offset : chain.offsets) {
+               text += std::format(" -> [+0x{:x}]", offset);
+             }
+             std::println("  {}", text);
+           }
            return {};
          } catch (const std::exception &e) {
            return std::unexpected{
-               std::format("Error searching memory: {}", e.what())};
+               std::format("Error scanning pointers: {}", e.what())};
+         }
+       }});
+
+  parser.add_command(
+      {.name = "strings",
+       .description = "extract printable strings from process memory",
+       .args = {"<pid>|--name <comm>", "[--min <n>]", "[--utf16]",
+                "[--region-filter <name>]", "[--budget <MB/s>]",
+                "[--max-cpu <cores>]", "[--adaptive]"},
+       .handler = [](std::span<const std::string_view> args)
+           -> std::expected<void, std::string> {
+         constexpr auto usage =
+             "Usage: strings <pid>|--name <comm> [--min <n>] [--utf16] "
+             "[--region-filter <name>] [--budget <MB/s>] [--max-cpu <cores>] "
+             "[--adaptive]";
+         if (args.empty()) {
+           return std::unexpected{usage};
+         }
+         try {
+           const auto targets = parse_targets(args);
+           pp::strings_options strings{};
+           std::optional<std::string_view> filter;
+           pp::scan_options options{};
+           throttle_args throttle;
+           for (std::size_t i = targets.used; i < args.size(); ++i) {
+             if (throttle.parse(args, i)) {
+               continue;
+             }
+             if (args[i] == "--min" && i + 1 < args.size()) {
+               strings.min_length = parse_value<std::size_t>(args[++i]);
+             } else if (args[i] == "--utf16") {
+               strings.utf16 = true;
+             } else if (args[i] == "--region-filter" && i + 1 < args.size()) {
+               filter = args[++i];
+             } else {
+               return std::unexpected{usage};
+             }
+           }
+
+           std::optional<pp::rate_limiter> limiter;
+           throttle.apply(targets.processes, limiter, options);
+
+           // every chunk's strings go out in one write, so lines of
+           // different chunks and processes never interleave
+           std::mutex output;
+           const auto results = pp::scan_fleet(
+               targets.processes, options,
+               [&](const pp::process &proc, const pp::scan_options &scan) {
+                 std::vector<pp::memory_region> regions;
+                 std::ranges::copy_if(
+                     proc.memory_regions(), std::back_inserter(regions),
+                     [&filter](const pp::memory_region &region) {
+                       if (!region.has_permissions(pp::permission::READ) ||
+                           region.name() == "[vvar]" ||
+                           region.name() == "[vsyscall]") {
+                         return false;
+                       }
+                       return !filter || region.name()
+                                             .value_or("[anonymous]")
+                                             .contains(*filter);
+                     });
+                 const auto tag = targets.tag(proc.pid());
+                 return pp::scan_strings(
+                     proc, regions, strings,
+                     [&output, &tag](std::span<const pp::found_string> found) {
+                       std::string lines;
+                       for (const auto &string : found) {
+                         std::format_to(
+                             std::back_inserter(lines), "{}0x{:x} {} {}\n",
+                             tag, string.address,
+                             string.encoding == pp::string_encoding::UTF16LE
+                                 ? 'u'
+                                 : 'a',
+                             string.text);
+                       }
+                       const std::lock_guard lock{output};
+                       std::fwrite(lines.data(), 1, lines.size(), stdout);
+                     },
+                     scan);
+               });
+           std::size_t total = 0;
+           print_results(targets, results,
+                         [&total](const std::string &, std::uint32_t,
+                                  std::size_t count) { total += count; });
+           std::println(stderr, "Total strings found: {}", total);
+           return {};
+         } catch (const std::exception &e) {
+           return std::unexpected{
+               std::format("Error extracting strings: {}", e.what())};
          }
        }});
 
@@ -604,43 +1532,66 @@ void load_commands(cli_parser &parser) {
        }});
 
   // Dump memory to file
-  // parser.add_command(
-  //     {.name = "dump",
-  //      .description = "dump memory region to file",
-  //      .args = {"<pid>", "<address>", "<size>", "<filename>"},
-  //      .handler = [](std::span<const std::string_view> args)
-  //          -> std::expected<void, std::string> {
-  //        if (args.size() < 4) {
-  //          return std::unexpected{
-  //              "Usage: dump <pid> <address> <size> <filename>"};
-  //        }
-  //
-  //        try {
-  //          const auto pid =
-  //              static_cast<std::uint32_t>(std::stoul(std::string{args[0]}));
-  //          const auto addr = std::stoull(std::string{args[1]}, nullptr, 16);
-  //          const auto size = std::stoull(std::string{args[2]});
-  //          const auto filename = std::string{args[3]};
-  //
-  //          pp::process proc{pid};
-  //          pp::memory_region region{addr, size, pp::permission::READ};
-  //          const auto memory = pp::read_memory_region(proc, region);
-  //
-  //          std::basic_ofstream<char> file(filename.c_str(),
-  //          std::ios::binary); if (!file) {
-  //            return std::unexpected{
-  //                std::format("Failed to open file: {}", filename)};
-  //          }
-  //
-  //          file.write(reinterpret_cast<const char *>(memory.data()),
-  //                     memory.size());
-  //          std::println("Successfully dumped {} bytes to {}", size,
-  //          filename); return {};
-  //        } catch (const std::exception &e) {
-  //          return std::unexpected{
-  //              std::format("Error dumping memory: {}", e.what())};
-  //        }
-  //      }});
+  parser.add_command(
+      {.name = "dump",
+       .description = "dump the readable memory of a process to a file",
+       .args = {"<pid>", "[--regions <filter>]", "[--include-swapped]",
+                "<filename>"},
+       .handler = [](std::span<const std::string_view> args)
+           -> std::expected<void, std::string> {
+         if (args.size() < 2) {
+           return std::unexpected{"Usage: dump <pid> [--regions <filter>] "
+                                  "[--include-swapped] <filename>"};
+         }
+
+         try {
+           const auto pid =
+               static_cast<std::uint32_t>(std::stoul(std::string{args[0]}));
+           std::optional<std::string_view> filter;
+           std::string_view filename;
+           pp::dump_options options{};
+           for (std::size_t i = 1; i < args.size(); ++i) {
+             if (args[i] == "--regions" && i + 1 < args.size()) {
+               filter = args[++i];
+             } else if (args[i] == "--include-swapped") {
+               options.include_swapped = true;
+             } else {
+               filename = args[i];
+             }
+           }
+           if (filename.empty()) {
+             return std::unexpected{"Output filename required"};
+           }
+
+           pp::process proc{pid};
+           // Regions whose name contains the filter, unnamed ones are
+           // [anonymous]
+           std::vector<pp::memory_region> regions = proc.memory_regions();
+           std::erase_if(regions, [filter](const pp::memory_region &region) {
+             const auto name = region.name().value_or("[anonymous]");
+             return !region.has_permissions(pp::permission::READ) ||
+                    name == "[vvar]" || name == "[vsyscall]" ||
+                    (filter && name.find(*filter) == std::string::npos);
+           });
+
+           const auto report = pp::dump_memory(
+               proc, regions, std::filesystem::path{filename}, options);
+           std::println("Dumped {} regions of process {} ({}) to {}, {} of {} "
+                        "bytes readable",
+                        report.regions.size(), pid, proc.name(), filename,
+                        report.read, report.size);
+           if (report.pages_skipped > 0) {
+             std::println("Skipped {} pages not in ram, left zero "
+                          "(--include-swapped reads them)",
+                          report.pages_skipped);
+           }
+           std::println("Region index written to {}.index", filename);
+           return {};
+         } catch (const std::exception &e) {
+           return std::unexpected{
+               std::format("Error dumping memory: {}", e.what())};
+         }
+       }});
 
   // Load file into memory
   parser.add_command(
@@ -795,16 +1746,19 @@ void load_commands(cli_parser &parser) {
            pp::process proc{pid};
            const auto functions = proc.functions();
 
-           std::println("Functions in process {} ({}):", pid, proc.name());
-           std::println("ADDRESS          NAME");
+           pp::output_sink out;
+           out.note("Functions in process {} ({}):", pid, proc.name());
+           out.note("ADDRESS          NAME");
 
            for (const auto &func : functions) {
              const auto name = should_demangle ? pp::demangle(func.name)
                                                : std::string{func.name};
-             std::println("0x{:012x}  {}", func.address, name);
+             out.record("function",
+                        {{"address", pp::hex{func.address}}, {"name", name}},
+                        "0x{:012x}  {}", func.address, name);
            }
 
-           std::println("\nTotal functions found: {}", functions.size());
+           out.note("\nTotal functions found: {}", functions.size());
 
            return {};
          } catch (const std::exception &e) {
@@ -835,10 +1789,10 @@ void load_commands(cli_parser &parser) {
            pp::process proc{pid};
            const auto functions = proc.functions();
 
-           std::println(
-               "Searching for functions matching '{}' in process {} ({}):",
-               pattern, pid, proc.name());
-           std::println("ADDRESS          NAME");
+           pp::output_sink out;
+           out.note("Searching for functions matching '{}' in process {} ({}):",
+                    pattern, pid, proc.name());
+           out.note("ADDRESS          NAME");
 
            size_t matches = 0;
            for (const auto &func : functions) {
@@ -846,12 +1800,15 @@ void load_commands(cli_parser &parser) {
                                                : std::string{func.name};
 
              if (name.find(pattern) != std::string::npos) {
-               std::println("0x{:012x}  {}", func.address, name);
+               out.record(
+                   "function",
+                   {{"address", pp::hex{func.address}}, {"name", name}},
+                   "0x{:012x}  {}", func.address, name);
                matches++;
              }
            }
 
-           std::println("\nFound {} matching functions", matches);
+           out.note("\nFound {} matching functions", matches);
 
            return {};
          } catch (const std::exception &e) {
@@ -956,7 +1913,7 @@ void load_commands(cli_parser &parser) {
   parser.add_command(
       {.name = "memstat",
        .description = "show memory statistics of process",
-       .args = {"<pid>"},
+       .args = {"<pid>", "[--numa]"},
        .handler = [](std::span<const std::string_view> args)
            -> std::expected<void, std::string> {
          if (args.empty())
@@ -987,6 +1944,44 @@ void load_commands(cli_parser &parser) {
            std::println("  Writable Memory: {} bytes", writable_memory);
            std::println("  Anonymous Regions: {}", anonymous_regions);
 
+           if (args.size() > 1 && args[1] == "--numa") {
+             const auto placement = pp::numa_placement(proc);
+             if (placement.empty()) {
+               return std::unexpected{"No NUMA placement: /proc/" +
+                                      std::string{args[0]} +
+                                      "/numa_maps is missing"};
+             }
+             std::vector<std::size_t> node_bytes;
+             std::println("\nNUMA placement (resident pages per node):");
+             for (const auto &region : proc.memory_regions()) {
+               const auto found = std::ranges::lower_bound(
+                   placement, region.begin(), {}, &pp::numa_region::begin);
+               if (found == placement.end() ||
+                   found->begin != region.begin()) {
+                 continue;
+               }
+               std::string nodes;
+               for (std::size_t node = 0; node < found->pages.size(); ++node) {
+                 if (found->pages[node] == 0) {
+                   continue;
+                 }
+                 nodes += std::format(" N{}={}", node, found->pages[node]);
+                 node_bytes.resize(std::max(node_bytes.size(), node + 1));
+                 node_bytes[node] += found->pages[node] * found->page_size;
+               }
+               if (nodes.empty()) {
+                 continue;
+               }
+               std::println("  0x{:x}-0x{:x} {} [{}]{}", region.begin(),
+                            region.begin() + region.size(),
+                            region.name().value_or("[anonymous]"),
+                            found->policy, nodes);
+             }
+             for (std::size_t node = 0; node < node_bytes.size(); ++node) {
+               std::println("  Node {}: {} bytes", node, node_bytes[node]);
+             }
+           }
+
            return {};
          } catch (const std::exception &e) {
            return std::unexpected{
@@ -994,6 +1989,179 @@ void load_commands(cli_parser &parser) {
          }
        }});
 
+  parser.add_command(
+      {.name = "memprofile",
+       .description = "classify resident pages as zero, low or high entropy "
+                      "per region name",
+       .args = {"<pid>", "[--threshold <bits per byte>]"},
+       .handler = [](std::span<const std::string_view> args)
+           -> std::expected<void, std::string> {
+         constexpr auto usage =
+             "Usage: memprofile <pid> [--threshold <bits per byte>]";
+         if (args.empty()) {
+           return std::unexpected{usage};
+         }
+         try {
+           const auto pid =
+               static_cast<std::uint32_t>(std::stoul(std::string{args[0]}));
+           double threshold = 6.0;
+           for (std::size_t i = 1; i < args.size(); ++i) {
+             if (args[i] == "--threshold" && i + 1 < args.size()) {
+               threshold = parse_value<double>(args[++i]);
+             } else {
+               return std::unexpected{usage};
+             }
+           }
+
+           const pp::process proc{pid};
+           std::vector<pp::memory_region> regions;
+           std::ranges::copy_if(proc.memory_regions(),
+                                std::back_inserter(regions),
+                                [](const pp::memory_region &region) {
+                                  return region.has_permissions(
+                                             pp::permission::READ) &&
+                                         region.name() != "[vvar]" &&
+                                         region.name() != "[vsyscall]";
+                                });
+           pp::scan_stats stats;
+           const auto profiles = pp::profile_pages(proc, regions, threshold,
+                                                   {.stats = &stats});
+
+           std::println("Resident pages of process {} ({}), low entropy is "
+                        "below {} bits per byte:",
+                        pid, proc.name(), threshold);
+           std::println("{:>10} {:>10} {:>10} {:>10} {:>8}  {}", "resident",
+                        "zero", "low", "high", "entropy", "region");
+           for (const auto &profile : profiles) {
+             if (profile.resident == 0) {
+               continue;
+             }
+             std::println("{:>10} {:>10} {:>10} {:>10} {:>8.2f}  {} ({})",
+                          profile.resident, profile.zero,
+                          profile.low_entropy, profile.high_entropy,
+                          profile.entropy, profile.name, profile.regions);
+           }
+           print_scan_stats(stats);
+           return {};
+         } catch (const std::exception &e) {
+           return std::unexpected{
+               std::format("Error profiling memory: {}", e.what())};
+         }
+       }});
+
+  parser.add_command(
+      {.name = "dedup",
+       .description = "estimate what merging identical pages (ksm) would "
+                      "save",
+       .args = {"<pid>...|--name <comm>", "[--top <n>]"},
+       .handler = [](std::span<const std::string_view> args)
+           -> std::expected<void, std::string> {
+         constexpr auto usage =
+             "Usage: dedup <pid>...|--name <comm> [--top <n>]";
+         if (args.empty()) {
+           return std::unexpected{usage};
+         }
+         try {
+           std::vector<pp::process> procs;
+           std::size_t top = 20;
+           for (std::size_t i = 0; i < args.size(); ++i) {
+             if (args[i] == "--name" && i + 1 < args.size()) {
+               std::ranges::copy(pp::find_process(args[++i]),
+                                 std::back_inserter(procs));
+             } else if (args[i] == "--top" && i + 1 < args.size()) {
+               top = parse_value<std::size_t>(args[++i]);
+             } else {
+               procs.emplace_back(parse_value<std::uint32_t>(args[i]));
+             }
+           }
+           if (procs.empty()) {
+             return std::unexpected{usage};
+           }
+
+           static const auto page_size =
+               static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+           const auto mib = [](std::size_t pages) {
+             return static_cast<double>(pages * page_size) / (1024.0 * 1024.0);
+           };
+           const auto report = pp::find_duplicate_pages(procs);
+           for (const auto &[pid, error] : report.failed) {
+             std::println(stderr, "[{}] {}", pid, error);
+           }
+           const auto duplicates = report.pages - report.unique;
+           std::println("Hashed {} resident pages of {} processes: {} unique, "
+                        "{} zero",
+                        report.pages, procs.size() - report.failed.size(),
+                        report.unique, report.zero);
+           std::println("Identical pages: {} ({:.1f} MiB could be merged)",
+                        duplicates, mib(duplicates));
+           std::println("Already shared: {} pages ({:.1f} MiB, not hashed)",
+                        report.shared, mib(report.shared));
+
+           std::println("\nBy region:");
+           for (const auto &region : report.regions | std::views::take(top)) {
+             if (region.duplicates == 0) {
+               break;
+             }
+             std::println("  {}: {} of {} pages ({:.1f} MiB)", region.name,
+                          region.duplicates, region.pages,
+                          mib(region.duplicates));
+           }
+           if (!report.pairs.empty()) {
+             std::println("\nBy process pair:");
+             for (const auto &pair : report.pairs | std::views::take(top)) {
+               std::println("  {} <-> {}: {} pages ({:.1f} MiB)", pair.first,
+                            pair.second, pair.shared, mib(pair.shared));
+             }
+           }
+           return {};
+         } catch (const std::exception &e) {
+           return std::unexpected{
+               std::format("Error finding duplicate pages: {}", e.what())};
+         }
+       }});
+
+  parser.add_command(
+      {.name = "calibrate",
+       .description = "measure the memory backends and remember the fastest "
+                      "one for each transfer size",
+       .args = {"<pid>"},
+       .handler = [](std::span<const std::string_view> args)
+           -> std::expected<void, std::string> {
+         if (args.empty()) {
+           return std::unexpected{"PID required"};
+         }
+         try {
+           const auto pid =
+               static_cast<std::uint32_t>(std::stoul(std::string{args[0]}));
+           const pp::process proc{pid};
+           std::println("Calibrating memory backends on {} ({}), the process "
+                        "is stopped for part of it",
+                        pid, proc.name());
+           const auto timings = pp::calibrate_backends(proc);
+           std::println("{:<12} {:<8} {:>10} {:>14} {:>14}", "backend",
+                        "state", "size", "latency (us)", "MiB/s");
+           for (const auto &timing : timings) {
+             std::println("{:<12} {:<8} {:>10} {:>14.3f} {:>14.1f}",
+                          pp::mem_backend_to_str(timing.backend),
+                          timing.stopped ? "stopped" : "running", timing.size,
+                          timing.latency_us, timing.throughput_mib);
+           }
+           const auto path = pp::calibration_path();
+           pp::save_calibration(path, timings);
+           std::println("Saved to {}", path.string());
+           for (const auto size : pp::calibration_sizes) {
+             if (const auto backend = pp::fastest_backend(timings, size)) {
+               std::println("  {} byte transfers use {}", size,
+                            pp::mem_backend_to_str(*backend));
+             }
+           }
+           return {};
+         } catch (const std::exception &e) {
+           return std::unexpected{
+               std::format("Error calibrating backends: {}", e.what())};
+         }
+       }});
+
   parser.add_command(
       {.name = "thread-info",
        .description = "show detailed thread information",
@@ -1048,7 +2216,11 @@ void load_commands(cli_parser &parser) {
            }
 
            const auto region = pp::addr_to_region(proc, *func_addr);
-           const auto bytes = pp::read_memory_region(proc, region);
+           // Only the bytes we show are read, not the whole region
+           std::array<std::byte, 32> preview{};
+           const auto bytes = std::span{preview}.first(std::min(
+               preview.size(), region.begin() + region.size() - *func_addr));
+           pp::read_memory(proc, *func_addr, bytes);
 
            std::println("Function Analysis for '{}':", func_name);
            std::println("  Address: 0x{:x}", *func_addr);
@@ -1062,10 +2234,8 @@ void load_commands(cli_parser &parser) {
 
            // Show first bytes of the function
            std::println("\nFirst 32 bytes:");
-           const auto offset = *func_addr - region.begin();
-           for (size_t i = 0; i < 32 && (offset + i) < bytes.size(); ++i) {
-             std::print("{:02x} ",
-                        static_cast<unsigned char>(bytes[offset + i]));
+           for (size_t i = 0; i < bytes.size(); ++i) {
+             std::print("{:02x} ", static_cast<unsigned char>(bytes[i]));
              if ((i + 1) % 16 == 0)
                std::println("");
            }
@@ -1131,15 +2301,52 @@ void load_commands(cli_parser &parser) {
            pp::process proc{pid};
            pp::disassembler disasm;
            pp::memory_region region{addr, size, pp::permission::READ};
+           pp::output_sink out;
 
            try {
-             const auto memory = pp::read_memory_region(proc, region);
-             const auto instructions = disasm.disassemble(memory, addr);
-
-             std::println("Disassembly of 0x{:x} (size: {} bytes):", addr,
+             // Longest x86 instruction is 15 bytes, so every instruction that
+             // starts inside a chunk ends inside its overlap
+             constexpr std::size_t max_instruction_size = 15;
+             pp::buffer_pool pool{1, 64 * 1024};
+             const pp::chunk_reader reader{proc, std::span{&region, 1}, pool,
+                                           max_instruction_size};
+
+             std::uintptr_t next = addr;
+             for (const auto &chunk : reader) {
+               const auto owned_end = chunk.address + chunk.size;
+               if (next >= owned_end) {
+                 continue;
+               }
+               // Stop at unreadable gaps
+               if (next < chunk.address) {
+                 break;
+               }
+               const auto instructions = disasm.disassemble(
+                   chunk.bytes.subspan(next - chunk.address), next);
+               if (next == addr) {
+                 out.note("Disassembly of 0x{:x} (size: {} bytes):", addr,
                           size);
-             for (const auto &inst : instructions) {
-               std::println("{}", inst);
+               }
+               for (const auto &inst : instructions) {
+                 if (inst.address() >= owned_end) {
+                   break;
+                 }
+                 out.record("instruction",
+                            {{"address", pp::hex{inst.address()}},
+                             {"mnemonic", inst.mnemonic()},
+                             {"operands", inst.operands()},
+                             {"size", inst.size()}},
+                            "{}", inst);
+                 next = inst.address() + inst.size();
+               }
+               // Capstone stops at the first invalid instruction
+               if (next < owned_end) {
+                 break;
+               }
+             }
+             if (next == addr) {
+               return std::unexpected{"Failed to disassemble: failed to read "
+                                      "memory"};
              }
              return {};
            } catch (const std::runtime_error &e) {
@@ -1155,6 +2362,72 @@ void load_commands(cli_parser &parser) {
                std::format("Error during disassembly: {}", e.what())};
          }
        }});
+
+  parser.add_command(
+      {.name = "insn-search",
+       .description = "search executable memory for an instruction sequence",
+       .args = {"<pid>", "<pattern>", "[--no-cache]"},
+       .handler = [](std::span<const std::string_view> args)
+           -> std::expected<void, std::string> {
+         constexpr auto usage =
+             "Usage: insn-search <pid> \"<mnemonic> <operands>; ...\" "
+             "[--no-cache]";
+         if (args.size() < 2) {
+           return std::unexpected{usage};
+         }
+         try {
+           const auto pid =
+               static_cast<std::uint32_t>(std::stoul(std::string{args[0]}));
+           bool use_cache = true;
+           for (const auto &arg : args.subspan(2)) {
+             if (arg == "--no-cache") {
+               use_cache = false;
+             } else {
+               return std::unexpected{usage};
+             }
+           }
+           const pp::insn_pattern pattern{args[1]};
+
+           const pp::process proc{pid};
+           std::vector<pp::memory_region> regions;
+           std::ranges::copy_if(
+               proc.memory_regions(), std::back_inserter(regions),
+               [](const pp::memory_region &region) {
+                 return region.has_permissions(pp::permission::READ |
+                                               pp::permission::EXECUTE) &&
+                        region.name() != "[vsyscall]";
+               });
+           std::println("Searching {} executable regions of process {} ({}) "
+                        "for '{}':",
+                        regions.size(), pid, proc.name(), args[1]);
+
+           std::optional<pp::decode_cache> cache{};
+           if (use_cache) {
+             cache.emplace(pp::decode_cache::default_dir());
+           }
+           const auto matches = pp::search_instructions(
+               proc, regions, pattern, cache ? &*cache : nullptr);
+           auto region = regions.cbegin();
+           for (const auto &match : matches) {
+             while (match.address >= region->begin() + region->size()) {
+               ++region;
+             }
+             std::string text;
+             for (const auto &insn : match.instructions) {
+               text += std::format("{}{} {}", text.empty() ? "" : "; ",
+                                   insn.mnemonic(), insn.operands());
+             }
+             std::println("Found at: 0x{:x} ({}+0x{:x}): {}", match.address,
+                          region->name().value_or("[anonymous]"),
+                          match.address - region->begin(), text);
+           }
+           std::println("Total matches found: {}", matches.size());
+           return {};
+         } catch (const std::exception &e) {
+           return std::unexpected{
+               std::format("Error searching instructions: {}", e.what())};
+         }
+       }});
 }
 
 } // namespace pp
@@ -24,6 +24,24 @@ public:
   ::cs_insn *instruction;
   std::size_t count;
 };
+
+// one instruction cs_disasm_iter decodes into again and again
+class capstone_instruction {
+public:
+  explicit capstone_instruction(::csh handle)
+      : instruction(::cs_malloc(handle)) {
+    if (instruction == nullptr) {
+      throw std::runtime_error("failed to allocate instruction");
+    }
+  }
+
+  ~capstone_instruction() { ::cs_free(instruction, 1); }
+
+  capstone_instruction(const capstone_instruction &) = delete;
+  capstone_instruction &operator=(const capstone_instruction &) = delete;
+
+  ::cs_insn *instruction;
+};
 } // namespace
 
 namespace pp {
@@ -56,6 +74,29 @@ disassembler::disassemble(std::span<const std::byte> data,
   return instructions;
 }
 
+std::vector<instruction>
+disassembler::disassemble_all(std::span<const std::byte> data,
+                              std::uintptr_t address) const {
+  std::vector<instruction> instructions{};
+  const capstone_instruction insn{handle};
+  const auto *code = reinterpret_cast<const uint8_t *>(data.data());
+  auto size = data.size();
+  std::uint64_t next = address;
+  while (size > 0) {
+    if (::cs_disasm_iter(handle, &code, &size, &next, insn.instruction)) {
+      instructions.emplace_back(insn.instruction->mnemonic,
+                                insn.instruction->op_str,
+                                insn.instruction->size,
+                                insn.instruction->address);
+    } else {
+      ++code;
+      --size;
+      ++next;
+    }
+  }
+  return instructions;
+}
+
 template <thread_or_process T>
 std::vector<instruction>
 disassembler::disassemble(const T &t, const memory_region &region) const {
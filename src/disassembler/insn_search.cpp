@@ -0,0 +1,379 @@
+#include "disassembler/insn_search.hpp"
+#include "memory_region/memio.hpp"
+#include "util/cache_dir.hpp"
+#include "util/read_file.hpp"
+#include "util/work_stealing_pool.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <ranges>
+#include <stdexcept>
+#include <system_error>
+
+#ifdef __linux__
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#error "only linux is supported"
+#endif
+
+namespace pp {
+
+namespace {
+
+constexpr std::array<char, 8> cache_magic{'P', 'P', 'I', 'N', 'S', 'N', 'S',
+                                          '1'};
+
+// the file a region maps, as it was when its entry was written
+struct file_identity {
+  std::uint64_t inode{0};
+  std::uint64_t size{0};
+  std::uint64_t mtime_ns{0};
+
+  bool operator==(const file_identity &other) const = default;
+};
+
+// entry layout: header, one record per instruction and then the mnemonics and
+// operands of every instruction back to back
+struct cache_header {
+  std::array<char, 8> magic{};
+  file_identity file{};
+  std::uint64_t begin{0};
+  std::uint64_t size{0};
+  std::uint64_t count{0};
+};
+
+struct insn_record {
+  std::uint64_t offset{0};
+  std::uint32_t size{0};
+  std::uint16_t mnemonic_size{0};
+  std::uint16_t operands_size{0};
+};
+
+static_assert(sizeof(cache_header) == 56 && sizeof(insn_record) == 16);
+
+[[nodiscard]] std::optional<file_identity>
+identify(const memory_region &region) {
+  const auto name = region.name();
+  if (!name || !name->starts_with('/')) {
+    return std::nullopt;
+  }
+  struct stat info {};
+  if (stat(name->c_str(), &info) == -1) {
+    return std::nullopt;
+  }
+  return file_identity{
+      .inode = info.st_ino,
+      .size = static_cast<std::uint64_t>(info.st_size),
+      .mtime_ns = static_cast<std::uint64_t>(info.st_mtim.tv_sec) *
+                      1'000'000'000 +
+                  static_cast<std::uint64_t>(info.st_mtim.tv_nsec)};
+}
+
+// entries of one mapping of a file share this start of their name, whatever
+// address the mapping had
+[[nodiscard]] std::string entry_prefix(const memory_region &region) {
+  return std::format("{:016x}-", std::hash<std::string>{}(std::format(
+                                     "{}:{:x}", region.name().value_or(""),
+                                     region.size())));
+}
+
+// one entry per file backed region, named after its path, size and address
+[[nodiscard]] std::string entry_name(const memory_region &region) {
+  return std::format("{}{:x}", entry_prefix(region), region.begin());
+}
+
+// lower case, spaces dropped
+[[nodiscard]] std::string normalize(std::string_view text) {
+  std::string normalized;
+  for (const auto c : text) {
+    if (std::isspace(static_cast<unsigned char>(c)) == 0) {
+      normalized += static_cast<char>(
+          std::tolower(static_cast<unsigned char>(c)));
+    }
+  }
+  return normalized;
+}
+
+// * matches any run of characters and ? any one. spaces in text are skipped,
+// pattern is normalized and has none
+[[nodiscard]] bool glob_match(std::string_view pattern,
+                              std::string_view text) noexcept {
+  constexpr auto none = std::string_view::npos;
+  std::size_t p = 0;
+  std::size_t t = 0;
+  // where to retry after the last * when the rest does not match
+  std::size_t star_p = none;
+  std::size_t star_t = 0;
+  while (true) {
+    while (t < text.size() && text[t] == ' ') {
+      ++t;
+    }
+    if (t == text.size()) {
+      break;
+    }
+    if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == text[t])) {
+      ++p;
+      ++t;
+    } else if (p < pattern.size() && pattern[p] == '*') {
+      star_p = ++p;
+      star_t = t;
+    } else if (star_p != none) {
+      p = star_p;
+      t = ++star_t;
+    } else {
+      return false;
+    }
+  }
+  while (p < pattern.size() && pattern[p] == '*') {
+    ++p;
+  }
+  return p == pattern.size();
+}
+
+} // namespace
+
+insn_pattern::insn_pattern(std::string_view text) {
+  for (const auto part : std::views::split(text, ';')) {
+    const std::string_view piece{part.begin(), part.end()};
+    const auto first = piece.find_first_not_of(" \t");
+    if (first == std::string_view::npos) {
+      throw std::invalid_argument(
+          std::format("empty instruction in pattern: {}", text));
+    }
+    const auto rest = piece.substr(first);
+    const auto space = rest.find_first_of(" \t");
+    insn_template templ{.mnemonic = normalize(rest.substr(0, space))};
+    if (space != std::string_view::npos) {
+      if (auto operands = normalize(rest.substr(space)); !operands.empty()) {
+        templ.operands = std::move(operands);
+      }
+    }
+    this->templates_.push_back(std::move(templ));
+  }
+  if (this->templates_.empty()) {
+    throw std::invalid_argument("empty instruction pattern");
+  }
+}
+
+[[nodiscard]] std::size_t insn_pattern::size() const noexcept {
+  return this->templates_.size();
+}
+
+[[nodiscard]] bool
+insn_pattern::matches(std::span<const instruction> insns) const {
+  if (insns.size() < this->templates_.size()) {
+    return false;
+  }
+  for (std::size_t i = 0; i < this->templates_.size(); ++i) {
+    const auto &templ = this->templates_[i];
+    const auto &insn = insns[i];
+    if (i > 0 && insns[i - 1].address() + insns[i - 1].size() !=
+                     insn.address()) {
+      return false;
+    }
+    if (!glob_match(templ.mnemonic, insn.mnemonic()) ||
+        (templ.operands && !glob_match(*templ.operands, insn.operands()))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+decode_cache::decode_cache(std::filesystem::path dir) : dir_{std::move(dir)} {}
+
+[[nodiscard]] std::filesystem::path decode_cache::default_dir() {
+  return cache_dir() / "insns";
+}
+
+[[nodiscard]] std::optional<std::vector<instruction>>
+decode_cache::load(const memory_region &region) const {
+  const auto identity = identify(region);
+  if (!identity) {
+    return std::nullopt;
+  }
+  std::string contents;
+  try {
+    contents = read_file((this->dir_ / entry_name(region)).string());
+  } catch (const std::system_error &) {
+    return std::nullopt;
+  }
+
+  cache_header header{};
+  if (contents.size() < sizeof(header)) {
+    return std::nullopt;
+  }
+  std::memcpy(&header, contents.data(), sizeof(header));
+  if (header.magic != cache_magic || header.file != *identity ||
+      header.begin != region.begin() || header.size != region.size() ||
+      header.count > contents.size() / sizeof(insn_record)) {
+    return std::nullopt;
+  }
+  auto text_offset = sizeof(header) + header.count * sizeof(insn_record);
+  if (text_offset > contents.size()) {
+    return std::nullopt;
+  }
+  std::vector<instruction> instructions{};
+  instructions.reserve(header.count);
+  for (std::size_t i = 0; i < header.count; ++i) {
+    insn_record record{};
+    std::memcpy(&record,
+                contents.data() + sizeof(header) + i * sizeof(record),
+                sizeof(record));
+    const auto text_size =
+        std::size_t{record.mnemonic_size} + record.operands_size;
+    if (text_size > contents.size() - text_offset) {
+      return std::nullopt;
+    }
+    const std::string_view text{contents.data() + text_offset, text_size};
+    instructions.emplace_back(text.substr(0, record.mnemonic_size),
+                              text.substr(record.mnemonic_size), record.size,
+                              region.begin() + record.offset);
+    text_offset += text_size;
+  }
+  return instructions;
+}
+
+void decode_cache::save(const memory_region &region,
+                        std::span<const instruction> instructions) const {
+  const auto identity = identify(region);
+  if (!identity) {
+    return;
+  }
+  std::filesystem::create_directories(this->dir_);
+  const auto path = this->dir_ / entry_name(region);
+  // written next to the entry and renamed over it, so a concurrent load sees
+  // the old entry or the new one
+  auto partial = path;
+  partial += std::format(".{}", getpid());
+  {
+    std::ofstream file{partial, std::ios_base::binary | std::ios_base::trunc};
+    if (!file.is_open()) {
+      throw std::filesystem::filesystem_error(
+          std::format("unable to open file: {}", partial.string()),
+          std::error_code());
+    }
+    const cache_header header{.magic = cache_magic,
+                              .file = *identity,
+                              .begin = region.begin(),
+                              .size = region.size(),
+                              .count = instructions.size()};
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    for (const auto &insn : instructions) {
+      const insn_record record{
+          .offset = insn.address() - region.begin(),
+          .size = static_cast<std::uint32_t>(insn.size()),
+          .mnemonic_size = static_cast<std::uint16_t>(insn.mnemonic().size()),
+          .operands_size = static_cast<std::uint16_t>(insn.operands().size())};
+      file.write(reinterpret_cast<const char *>(&record), sizeof(record));
+    }
+    for (const auto &insn : instructions) {
+      file.write(insn.mnemonic().data(),
+                 static_cast<std::streamsize>(insn.mnemonic().size()));
+      file.write(insn.operands().data(),
+                 static_cast<std::streamsize>(insn.operands().size()));
+    }
+    if (!file.good()) {
+      throw std::filesystem::filesystem_error(
+          std::format("unable to write file: {}", partial.string()),
+          std::error_code());
+    }
+  }
+  std::filesystem::rename(partial, path);
+
+  // a restart of the target maps the file at another address, the entries
+  // of earlier addresses would never be loaded again. partial entries of
+  // concurrent saves have a dot in their name and are left alone.
+  const auto prefix = entry_prefix(region);
+  std::error_code error;
+  for (const auto &entry :
+       std::filesystem::directory_iterator{this->dir_, error}) {
+    const auto name = entry.path().filename().string();
+    if (name.starts_with(prefix) && name != path.filename() &&
+        !name.contains('.')) {
+      std::filesystem::remove(entry.path(), error);
+    }
+  }
+}
+
+[[nodiscard]] std::vector<instruction>
+decode_region(const process &proc, const memory_region &region,
+              const disassembler &disasm) {
+  std::vector<std::byte> bytes(region.size());
+  const auto ranges = read_memory_ranges(proc, region.begin(), bytes);
+  if (!ranges) {
+    throw std::system_error(
+        ranges.error(),
+        std::format("failed to read memory region beginning at: {:x}",
+                    region.begin()));
+  }
+  std::vector<instruction> instructions{};
+  for (const auto &range : *ranges) {
+    auto decoded = disasm.disassemble_all(
+        std::span{bytes}.subspan(range.offset, range.size),
+        region.begin() + range.offset);
+    instructions.insert(instructions.end(),
+                        std::make_move_iterator(decoded.begin()),
+                        std::make_move_iterator(decoded.end()));
+  }
+  return instructions;
+}
+
+[[nodiscard]] std::vector<insn_match>
+search_instructions(const process &proc, std::span<const memory_region> regions,
+                    const insn_pattern &pattern, const decode_cache *cache,
+                    std::size_t threads) {
+  const work_stealing_pool pool{threads};
+  // capstone handles are not shared between threads
+  std::vector<std::unique_ptr<disassembler>> disassemblers(pool.size());
+  std::vector<std::vector<insn_match>> found(regions.size());
+  pool.run(regions.size(), [&](std::size_t worker, std::size_t task) {
+    const auto &region = regions[task];
+    std::optional<std::vector<instruction>> cached{};
+    if (cache != nullptr) {
+      cached = cache->load(region);
+    }
+    std::vector<instruction> instructions{};
+    if (cached) {
+      instructions = std::move(*cached);
+    } else {
+      if (!disassemblers[worker]) {
+        disassemblers[worker] = std::make_unique<disassembler>();
+      }
+      instructions = decode_region(proc, region, *disassemblers[worker]);
+      if (cache != nullptr) {
+        try {
+          cache->save(region, instructions);
+        } catch (const std::filesystem::filesystem_error &) {
+          // an entry that cannot be written costs the next query a decode
+        }
+      }
+    }
+    const std::span<const instruction> insns{instructions};
+    for (std::size_t i = 0; i < insns.size(); ++i) {
+      if (pattern.matches(insns.subspan(i))) {
+        const auto match = insns.subspan(i, pattern.size());
+        found[task].push_back({.address = match.front().address(),
+                               .instructions = {match.begin(), match.end()}});
+      }
+    }
+  });
+
+  std::vector<insn_match> matches{};
+  for (auto &region_matches : found) {
+    matches.insert(matches.end(),
+                   std::make_move_iterator(region_matches.begin()),
+                   std::make_move_iterator(region_matches.end()));
+  }
+  std::ranges::sort(matches, {}, &insn_match::address);
+  return matches;
+}
+
+} // namespace pp
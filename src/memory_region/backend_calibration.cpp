@@ -0,0 +1,183 @@
+#include "memory_region/backend_calibration.hpp"
+#include "debugger/debugger.hpp"
+#include "util/cache_dir.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <format>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+namespace pp {
+
+namespace {
+
+// every backend and size gets this much time, at least one timed read
+constexpr auto time_budget = std::chrono::milliseconds{200};
+constexpr std::size_t max_reads = 100'000;
+
+// nullopt when the backend cannot read the range in one go
+[[nodiscard]] std::optional<backend_timing>
+measure(mem_backend backend, bool stopped, std::uint32_t id,
+        std::uintptr_t address, std::span<std::byte> buffer) {
+  // the first read also faults the pages in, it is not timed
+  const auto warm_up = remote_read(backend, id, address, buffer);
+  if (!warm_up || *warm_up != buffer.size()) {
+    return std::nullopt;
+  }
+  const auto start = std::chrono::steady_clock::now();
+  std::size_t reads = 0;
+  auto elapsed = std::chrono::steady_clock::duration{};
+  do {
+    if (!remote_read(backend, id, address, buffer)) {
+      return std::nullopt;
+    }
+    ++reads;
+    elapsed = std::chrono::steady_clock::now() - start;
+  } while (reads < max_reads && elapsed < time_budget);
+
+  const auto seconds = std::chrono::duration<double>(elapsed).count();
+  const auto bytes = static_cast<double>(reads * buffer.size());
+  return backend_timing{
+      .backend = backend,
+      .stopped = stopped,
+      .size = buffer.size(),
+      .latency_us = seconds * 1e6 / static_cast<double>(reads),
+      .throughput_mib = bytes / (1024.0 * 1024.0) / seconds};
+}
+
+void measure_all(std::span<const mem_backend> backends, bool stopped,
+                 std::uint32_t id, const memory_region &region,
+                 std::vector<std::byte> &buffer,
+                 std::vector<backend_timing> &timings) {
+  for (const auto size : calibration_sizes) {
+    if (size > region.size()) {
+      continue;
+    }
+    buffer.resize(size);
+    for (const auto backend : backends) {
+      if (const auto timing =
+              measure(backend, stopped, id, region.begin(), buffer)) {
+        timings.push_back(*timing);
+      }
+    }
+  }
+}
+
+} // namespace
+
+[[nodiscard]] std::vector<backend_timing>
+calibrate_backends(const process &proc) {
+  std::vector<memory_region> regions = proc.memory_regions();
+  std::erase_if(regions, [](const memory_region &region) {
+    // the kernel's pages, which none of the backends can read
+    return !region.has_permissions(permission::READ) ||
+           region.name() == "[vvar]" || region.name() == "[vsyscall]";
+  });
+  if (regions.empty()) {
+    throw std::runtime_error(
+        std::format("process {} has no readable memory", proc.pid()));
+  }
+  const auto region =
+      *std::ranges::max_element(regions, {}, &memory_region::size);
+
+  std::vector<backend_timing> timings{};
+  std::vector<std::byte> buffer{};
+  constexpr std::array running{mem_backend::PROCESS_VM, mem_backend::PROC_MEM};
+  measure_all(running, false, proc.pid(), region, buffer, timings);
+  {
+    process target{proc.pid()};
+    const debugger stopped{target};
+    constexpr std::array backends{mem_backend::PROCESS_VM,
+                                  mem_backend::PROC_MEM, mem_backend::PTRACE};
+    measure_all(backends, true, proc.pid(), region, buffer, timings);
+  }
+  return timings;
+}
+
+[[nodiscard]] std::filesystem::path calibration_path() {
+  return cache_dir() / "backends";
+}
+
+void save_calibration(const std::filesystem::path &path,
+                      std::span<const backend_timing> timings) {
+  std::filesystem::create_directories(path.parent_path());
+  std::ofstream file{path, std::ios_base::trunc};
+  if (!file.is_open()) {
+    throw std::filesystem::filesystem_error(
+        std::format("unable to open file: {}", path.string()),
+        std::error_code());
+  }
+  file << "# backend state size latency_us throughput_mib\n";
+  for (const auto &timing : timings) {
+    file << std::format("{} {} {} {} {}\n", mem_backend_to_str(timing.backend),
+                        timing.stopped ? "stopped" : "running", timing.size,
+                        timing.latency_us, timing.throughput_mib);
+  }
+  if (!file.good()) {
+    throw std::filesystem::filesystem_error(
+        std::format("unable to write file: {}", path.string()),
+        std::error_code());
+  }
+}
+
+[[nodiscard]] std::vector<backend_timing>
+load_calibration(const std::filesystem::path &path) {
+  std::ifstream file{path};
+  if (!file.is_open()) {
+    return {};
+  }
+  std::vector<backend_timing> timings{};
+  std::string line{};
+  while (std::getline(file, line)) {
+    std::istringstream iss{line};
+    std::string backend{};
+    std::string state{};
+    backend_timing timing{};
+    if (!(iss >> backend >> state >> timing.size >> timing.latency_us >>
+          timing.throughput_mib)) {
+      continue;
+    }
+    const auto parsed = str_to_mem_backend(backend);
+    if (!parsed || (state != "running" && state != "stopped")) {
+      continue;
+    }
+    timing.backend = *parsed;
+    timing.stopped = state == "stopped";
+    timings.push_back(timing);
+  }
+  return timings;
+}
+
+[[nodiscard]] std::optional<mem_backend>
+fastest_backend(std::span<const backend_timing> timings, std::size_t size) {
+  std::optional<std::size_t> size_class{};
+  std::size_t largest = 0;
+  for (const auto &timing : timings) {
+    if (timing.stopped) {
+      continue;
+    }
+    largest = std::max(largest, timing.size);
+    if (timing.size >= size && (!size_class || timing.size < *size_class)) {
+      size_class = timing.size;
+    }
+  }
+  if (largest == 0) {
+    return std::nullopt;
+  }
+  const auto chosen = size_class.value_or(largest);
+
+  const backend_timing *best = nullptr;
+  for (const auto &timing : timings) {
+    if (!timing.stopped && timing.size == chosen &&
+        (best == nullptr || timing.throughput_mib > best->throughput_mib)) {
+      best = &timing;
+    }
+  }
+  return best->backend;
+}
+
+} // namespace pp
@@ -0,0 +1,153 @@
+#include "memory_region/batch_io.hpp"
+#include "memory_region/mem_backend.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <format>
+#include <numeric>
+#include <system_error>
+
+#ifdef __linux__
+#include <sys/uio.h>
+#else
+#error "only linux is supported"
+#endif
+
+namespace pp {
+
+namespace {
+
+// runs transfer(local, local_count, remote, remote_count) over the requests in
+// address order, element i of the result tells whether request i went
+// through completely
+template <typename Request, typename Transfer>
+[[nodiscard]] std::vector<bool>
+submit_requests(std::span<const Request> requests, Transfer &&transfer) {
+  std::vector<bool> done(requests.size(), false);
+  std::vector<std::size_t> order(requests.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::ranges::stable_sort(order, {}, [&](std::size_t i) {
+    return requests[i].address;
+  });
+
+  std::vector<iovec> local{};
+  std::vector<iovec> remote{};
+  // positions in order of the requests in local
+  std::vector<std::size_t> batch{};
+  local.reserve(IOV_MAX);
+  remote.reserve(IOV_MAX);
+  batch.reserve(IOV_MAX);
+  std::size_t pos = 0;
+  while (pos < order.size()) {
+    local.clear();
+    remote.clear();
+    batch.clear();
+    std::uintptr_t remote_end = 0;
+    for (; pos < order.size() && local.size() < IOV_MAX; ++pos) {
+      const auto &request = requests[order[pos]];
+      if (request.bytes.empty()) {
+        done[order[pos]] = true;
+        continue;
+      }
+      // back to back requests are one remote range scattered into several
+      // local buffers
+      if (!remote.empty() && request.address == remote_end) {
+        remote.back().iov_len += request.bytes.size();
+      } else if (remote.size() < IOV_MAX) {
+        remote.push_back({.iov_base = reinterpret_cast<void *>(request.address),
+                          .iov_len = request.bytes.size()});
+      } else {
+        break;
+      }
+      remote_end = request.address + request.bytes.size();
+      local.push_back(
+          {.iov_base = const_cast<void *>(
+               reinterpret_cast<const void *>(request.bytes.data())),
+           .iov_len = request.bytes.size()});
+      batch.push_back(pos);
+    }
+    if (local.empty()) {
+      break;
+    }
+
+    const auto result =
+        transfer(local.data(), local.size(), remote.data(), remote.size());
+    if (result < 0 && errno != EFAULT) {
+      throw std::system_error(
+          errno, std::generic_category(),
+          std::format("failed to transfer {} memory ranges", local.size()));
+    }
+    auto transferred = result < 0 ? 0 : static_cast<std::size_t>(result);
+    std::size_t i = 0;
+    for (; i < batch.size() && local[i].iov_len <= transferred; ++i) {
+      done[order[batch[i]]] = true;
+      transferred -= local[i].iov_len;
+    }
+    // the transfer stopped inside request i, go on right after it
+    if (i < batch.size()) {
+      pos = batch[i] + 1;
+    }
+  }
+  return done;
+}
+
+} // namespace
+
+std::size_t batch_reader::add(std::uintptr_t address,
+                              std::span<std::byte> out) {
+  this->requests_.push_back({.address = address, .bytes = out});
+  return this->requests_.size() - 1;
+}
+
+[[nodiscard]] std::size_t batch_reader::size() const noexcept {
+  return this->requests_.size();
+}
+
+[[nodiscard]] std::vector<bool> batch_reader::submit() {
+  const auto requests = std::move(this->requests_);
+  this->requests_ = {};
+  return submit_requests(
+      std::span{requests}, [this](const iovec *local, std::size_t local_count,
+                                  const iovec *remote,
+                                  std::size_t remote_count) {
+        return process_vm_readv(static_cast<std::int32_t>(this->id_), local,
+                                local_count, remote, remote_count, 0);
+      });
+}
+
+std::size_t batch_writer::add(std::uintptr_t address,
+                              std::span<const std::byte> data) {
+  this->requests_.push_back({.address = address, .bytes = data});
+  return this->requests_.size() - 1;
+}
+
+[[nodiscard]] std::size_t batch_writer::size() const noexcept {
+  return this->requests_.size();
+}
+
+[[nodiscard]] std::vector<bool> batch_writer::submit() {
+  const auto requests = std::move(this->requests_);
+  this->requests_ = {};
+  // the other backends write one request at a time, process_vm_writev would
+  // refuse pages they can write
+  if (const auto backend = active_mem_backend();
+      backend != mem_backend::PROCESS_VM) {
+    std::vector<bool> written(requests.size());
+    for (std::size_t i = 0; i < requests.size(); ++i) {
+      const auto &[address, bytes] = requests[i];
+      const auto result = remote_write(backend, this->id_, address, bytes);
+      written[i] = result && *result == bytes.size();
+    }
+    return written;
+  }
+  return submit_requests(
+      std::span{requests}, [this](const iovec *local, std::size_t local_count,
+                                  const iovec *remote,
+                                  std::size_t remote_count) {
+        return process_vm_writev(static_cast<std::int32_t>(this->id_), local,
+                                 local_count, remote, remote_count, 0);
+      });
+}
+
+} // namespace pp
@@ -0,0 +1,617 @@
+#include "memory_region/byte_regex.hpp"
+
+#include <algorithm>
+#include <bitset>
+#include <cctype>
+#include <format>
+#include <limits>
+#include <map>
+#include <optional>
+#include <ranges>
+#include <stdexcept>
+
+namespace pp {
+
+namespace {
+
+using byte_set = std::bitset<256>;
+
+constexpr auto unbounded = std::numeric_limits<std::size_t>::max();
+constexpr auto none = std::numeric_limits<std::uint32_t>::max();
+constexpr std::size_t max_repeat = 1000;
+constexpr std::size_t max_dfa_states = 10000;
+
+struct node {
+  enum class kind { SET, CONCAT, ALTERNATE, REPEAT };
+  kind type{kind::SET};
+  byte_set bytes{};
+  std::vector<node> children{};
+  std::size_t min{0};
+  std::size_t max{0};
+};
+
+[[nodiscard]] byte_set byte_range(unsigned char first, unsigned char last) {
+  byte_set set{};
+  for (auto c = static_cast<std::size_t>(first); c <= last; ++c) {
+    set.set(c);
+  }
+  return set;
+}
+
+class regex_parser {
+  std::string_view pattern_{};
+  std::size_t pos_{0};
+  bool fold_case_{false};
+
+  [[noreturn]] void fail(std::string_view what) const {
+    throw std::invalid_argument(std::format("{} at offset {} in regex: {}",
+                                            what, this->pos_, this->pattern_));
+  }
+
+  [[nodiscard]] bool at_end() const noexcept {
+    return this->pos_ >= this->pattern_.size();
+  }
+
+  [[nodiscard]] char peek() const noexcept {
+    return this->pattern_[this->pos_];
+  }
+
+  [[nodiscard]] byte_set fold(byte_set set) const {
+    if (!this->fold_case_) {
+      return set;
+    }
+    for (std::size_t c = 'a'; c <= 'z'; ++c) {
+      const auto upper = c - 'a' + 'A';
+      if (set[c] || set[upper]) {
+        set.set(c);
+        set.set(upper);
+      }
+    }
+    return set;
+  }
+
+  [[nodiscard]] unsigned char parse_hex_digit() {
+    if (this->at_end() ||
+        std::isxdigit(static_cast<unsigned char>(this->peek())) == 0) {
+      this->fail("expected a hex digit");
+    }
+    const auto c = static_cast<unsigned char>(this->pattern_[this->pos_++]);
+    return static_cast<unsigned char>(
+        std::isdigit(c) != 0 ? c - '0' : std::tolower(c) - 'a' + 10);
+  }
+
+  // the set of an escape, the backslash is already consumed
+  [[nodiscard]] byte_set parse_escape() {
+    if (this->at_end()) {
+      this->fail("trailing backslash");
+    }
+    const auto c = static_cast<unsigned char>(this->pattern_[this->pos_++]);
+    const auto digits = byte_range('0', '9');
+    const auto word = digits | byte_range('a', 'z') | byte_range('A', 'Z') |
+                      byte_range('_', '_');
+    const auto space = byte_range('\t', '\r') | byte_range(' ', ' ');
+    switch (c) {
+    case 'd':
+      return digits;
+    case 'D':
+      return ~digits;
+    case 'w':
+      return word;
+    case 'W':
+      return ~word;
+    case 's':
+      return space;
+    case 'S':
+      return ~space;
+    case 'n':
+      return byte_range('\n', '\n');
+    case 'r':
+      return byte_range('\r', '\r');
+    case 't':
+      return byte_range('\t', '\t');
+    case 'f':
+      return byte_range('\f', '\f');
+    case 'v':
+      return byte_range('\v', '\v');
+    case '0':
+      return byte_range('\0', '\0');
+    case 'x': {
+      const auto high = this->parse_hex_digit();
+      const auto low = this->parse_hex_digit();
+      const auto value = static_cast<unsigned char>((high << 4) | low);
+      return byte_range(value, value);
+    }
+    default:
+      if (std::isalnum(c) != 0) {
+        --this->pos_;
+        this->fail("unsupported escape");
+      }
+      return byte_range(c, c);
+    }
+  }
+
+  // a single byte or escape inside [...], the byte is set when it can start
+  // or end a range
+  [[nodiscard]] std::pair<byte_set, std::optional<unsigned char>>
+  parse_class_item() {
+    const auto c = static_cast<unsigned char>(this->pattern_[this->pos_++]);
+    if (c != '\\') {
+      return {byte_range(c, c), c};
+    }
+    const auto set = this->parse_escape();
+    if (set.count() != 1) {
+      return {set, std::nullopt};
+    }
+    for (std::size_t b = 0; b < set.size(); ++b) {
+      if (set[b]) {
+        return {set, static_cast<unsigned char>(b)};
+      }
+    }
+    return {set, std::nullopt};
+  }
+
+  // the set of a [...] class, the '[' is already consumed
+  [[nodiscard]] byte_set parse_class() {
+    bool negate = false;
+    if (!this->at_end() && this->peek() == '^') {
+      negate = true;
+      ++this->pos_;
+    }
+    byte_set set{};
+    bool first = true;
+    while (true) {
+      if (this->at_end()) {
+        this->fail("missing ']'");
+      }
+      if (this->peek() == ']' && !first) {
+        ++this->pos_;
+        break;
+      }
+      first = false;
+      const auto [item, low] = this->parse_class_item();
+      if (this->pos_ + 1 < this->pattern_.size() && this->peek() == '-' &&
+          this->pattern_[this->pos_ + 1] != ']') {
+        ++this->pos_;
+        const auto [last_item, high] = this->parse_class_item();
+        if (!low || !high || *high < *low) {
+          this->fail("invalid range in class");
+        }
+        set |= byte_range(*low, *high);
+      } else {
+        set |= item;
+      }
+    }
+    set = this->fold(set);
+    return negate ? ~set : set;
+  }
+
+  // {n}, {n,} or {n,m}, nullopt leaves a '{' that starts none of them to be
+  // taken literally
+  [[nodiscard]] std::optional<std::pair<std::size_t, std::size_t>>
+  parse_bounds() {
+    const auto begin = this->pos_;
+    const auto number = [this]() -> std::optional<std::size_t> {
+      std::size_t value = 0;
+      const auto start = this->pos_;
+      while (!this->at_end() &&
+             std::isdigit(static_cast<unsigned char>(this->peek())) != 0) {
+        value = std::min(value * 10 + static_cast<std::size_t>(
+                                          this->pattern_[this->pos_++] - '0'),
+                         max_repeat + 1);
+      }
+      return this->pos_ == start ? std::nullopt : std::optional{value};
+    };
+    ++this->pos_;
+    const auto min = number();
+    auto max = min;
+    if (min && !this->at_end() && this->peek() == ',') {
+      ++this->pos_;
+      max = number();
+      if (!max) {
+        max = unbounded;
+      }
+    }
+    if (!min || this->at_end() || this->peek() != '}') {
+      this->pos_ = begin;
+      return std::nullopt;
+    }
+    ++this->pos_;
+    if ((*max != unbounded && *max > max_repeat) || *min > max_repeat) {
+      this->fail(std::format("repetition above {}", max_repeat));
+    }
+    if (*max < *min) {
+      this->fail("invalid repetition bounds");
+    }
+    return std::pair{*min, *max};
+  }
+
+  [[nodiscard]] node parse_atom() {
+    const auto c = static_cast<unsigned char>(this->pattern_[this->pos_++]);
+    switch (c) {
+    case '(': {
+      if (this->pattern_.substr(this->pos_).starts_with("?:")) {
+        this->pos_ += 2;
+      } else if (!this->at_end() && this->peek() == '?') {
+        this->fail("unsupported group");
+      }
+      auto inner = this->parse_alternation();
+      if (this->at_end() || this->peek() != ')') {
+        this->fail("missing ')'");
+      }
+      ++this->pos_;
+      return inner;
+    }
+    case '[':
+      return {.bytes = this->parse_class()};
+    case '.':
+      return {.bytes = ~byte_set{}};
+    case '\\':
+      return {.bytes = this->fold(this->parse_escape())};
+    case '^':
+    case '$':
+      --this->pos_;
+      this->fail("anchors are not supported");
+    case '*':
+    case '+':
+    case '?':
+      --this->pos_;
+      this->fail("nothing to repeat");
+    default:
+      return {.bytes = this->fold(byte_range(c, c))};
+    }
+  }
+
+  [[nodiscard]] node parse_repeat() {
+    auto atom = this->parse_atom();
+    while (!this->at_end()) {
+      std::pair<std::size_t, std::size_t> bounds{};
+      if (this->peek() == '*') {
+        bounds = {0, unbounded};
+        ++this->pos_;
+      } else if (this->peek() == '+') {
+        bounds = {1, unbounded};
+        ++this->pos_;
+      } else if (this->peek() == '?') {
+        bounds = {0, 1};
+        ++this->pos_;
+      } else if (const auto parsed =
+                     this->peek() == '{' ? this->parse_bounds() : std::nullopt;
+                 parsed) {
+        bounds = *parsed;
+      } else {
+        break;
+      }
+      // lazy quantifiers make no difference to leftmost-longest matching
+      if (!this->at_end() && this->peek() == '?') {
+        ++this->pos_;
+      }
+      node repeat{.type = node::kind::REPEAT,
+                  .min = bounds.first,
+                  .max = bounds.second};
+      repeat.children.push_back(std::move(atom));
+      atom = std::move(repeat);
+    }
+    return atom;
+  }
+
+  [[nodiscard]] node parse_concat() {
+    node concat{.type = node::kind::CONCAT};
+    while (!this->at_end() && this->peek() != '|' && this->peek() != ')') {
+      concat.children.push_back(this->parse_repeat());
+    }
+    return concat;
+  }
+
+  [[nodiscard]] node parse_alternation() {
+    node alternation{.type = node::kind::ALTERNATE};
+    alternation.children.push_back(this->parse_concat());
+    while (!this->at_end() && this->peek() == '|') {
+      ++this->pos_;
+      alternation.children.push_back(this->parse_concat());
+    }
+    return alternation;
+  }
+
+public:
+  explicit regex_parser(std::string_view pattern) : pattern_{pattern} {}
+
+  [[nodiscard]] node parse() {
+    if (this->pattern_.starts_with("(?i)")) {
+      this->fold_case_ = true;
+      this->pos_ = 4;
+    }
+    auto tree = this->parse_alternation();
+    if (!this->at_end()) {
+      this->fail("unmatched ')'");
+    }
+    return tree;
+  }
+};
+
+void collect_sets(const node &tree, std::vector<byte_set> &sets) {
+  if (tree.type == node::kind::SET) {
+    sets.push_back(tree.bytes);
+  }
+  for (const auto &child : tree.children) {
+    collect_sets(child, sets);
+  }
+}
+
+// consuming states move to out on any byte in bytes, the others are epsilon
+// splits to out and out2. state 0 is the match state.
+struct nfa_state {
+  byte_set bytes{};
+  std::uint32_t out{none};
+  std::uint32_t out2{none};
+  bool consumes{false};
+};
+
+class nfa_builder {
+  std::vector<nfa_state> states_{nfa_state{}};
+  bool reverse_{false};
+
+  [[nodiscard]] std::uint32_t add(const nfa_state &state) {
+    this->states_.push_back(state);
+    return static_cast<std::uint32_t>(this->states_.size() - 1);
+  }
+
+public:
+  // a reverse nfa matches the reversed strings
+  explicit nfa_builder(bool reverse) : reverse_{reverse} {}
+
+  [[nodiscard]] const std::vector<nfa_state> &states() const noexcept {
+    return this->states_;
+  }
+
+  // start state of tree followed by next
+  [[nodiscard]] std::uint32_t compile(const node &tree, std::uint32_t next) {
+    switch (tree.type) {
+    case node::kind::SET:
+      return this->add({.bytes = tree.bytes, .out = next, .consumes = true});
+    case node::kind::CONCAT:
+      if (this->reverse_) {
+        for (const auto &child : tree.children) {
+          next = this->compile(child, next);
+        }
+      } else {
+        for (const auto &child : tree.children | std::views::reverse) {
+          next = this->compile(child, next);
+        }
+      }
+      return next;
+    case node::kind::ALTERNATE: {
+      auto start = this->compile(tree.children.back(), next);
+      for (auto i = tree.children.size() - 1; i > 0; --i) {
+        const auto branch = this->compile(tree.children[i - 1], next);
+        start = this->add({.out = branch, .out2 = start});
+      }
+      return start;
+    }
+    case node::kind::REPEAT: {
+      const auto &child = tree.children.front();
+      auto start = next;
+      if (tree.max == unbounded) {
+        const auto loop = this->add({});
+        const auto body = this->compile(child, loop);
+        this->states_[loop].out = body;
+        this->states_[loop].out2 = next;
+        start = loop;
+      } else {
+        for (auto i = tree.min; i < tree.max; ++i) {
+          const auto body = this->compile(child, start);
+          start = this->add({.out = body, .out2 = next});
+        }
+      }
+      for (std::size_t i = 0; i < tree.min; ++i) {
+        start = this->compile(child, start);
+      }
+      return start;
+    }
+    }
+    return next;
+  }
+
+  // start state that skips any number of bytes before start
+  [[nodiscard]] std::uint32_t unanchored(std::uint32_t start) {
+    const auto loop = this->add({});
+    const auto any = this->add({.bytes = ~byte_set{}, .out = loop,
+                                .consumes = true});
+    this->states_[loop].out = start;
+    this->states_[loop].out2 = any;
+    return loop;
+  }
+};
+
+// subset construction into transitions, returns the start row. each dfa
+// state is the sorted set of consuming nfa states it stands for plus the match
+// state.
+[[nodiscard]] std::uint32_t
+build_dfa(const std::vector<nfa_state> &nfa, std::uint32_t start,
+          const std::array<std::uint16_t, 256> &byte_class,
+          std::size_t class_count, std::uint32_t match_flag,
+          std::vector<std::uint32_t> &transitions) {
+  std::vector<unsigned char> representative(class_count);
+  for (std::size_t b = 0; b < byte_class.size(); ++b) {
+    representative[byte_class[b]] = static_cast<unsigned char>(b);
+  }
+
+  std::vector<std::uint8_t> seen(nfa.size());
+  const auto closure = [&](std::vector<std::uint32_t> pending) {
+    std::ranges::fill(seen, 0);
+    std::vector<std::uint32_t> states{};
+    while (!pending.empty()) {
+      const auto state = pending.back();
+      pending.pop_back();
+      if (seen[state] != 0) {
+        continue;
+      }
+      seen[state] = 1;
+      if (state == 0 || nfa[state].consumes) {
+        states.push_back(state);
+      } else {
+        pending.push_back(nfa[state].out);
+        pending.push_back(nfa[state].out2);
+      }
+    }
+    std::ranges::sort(states);
+    return states;
+  };
+
+  std::map<std::vector<std::uint32_t>, std::uint32_t> ids{};
+  std::vector<std::vector<std::uint32_t>> sets{};
+  const auto row = [&](std::vector<std::uint32_t> set) {
+    const auto accepting = !set.empty() && set.front() == 0;
+    auto [it, inserted] =
+        ids.try_emplace(set, static_cast<std::uint32_t>(sets.size()));
+    if (inserted) {
+      if (sets.size() == max_dfa_states) {
+        throw std::length_error("regex needs too many dfa states");
+      }
+      sets.push_back(std::move(set));
+      transitions.resize(sets.size() * class_count);
+    }
+    return static_cast<std::uint32_t>(it->second * class_count) |
+           (accepting ? match_flag : 0);
+  };
+
+  // the empty set is the dead state in row 0
+  transitions.clear();
+  static_cast<void>(row({}));
+  const auto start_row = row(closure({start}));
+  for (std::size_t id = 1; id < sets.size(); ++id) {
+    for (std::size_t c = 0; c < class_count; ++c) {
+      std::vector<std::uint32_t> targets{};
+      for (const auto state : sets[id]) {
+        if (state != 0 && nfa[state].bytes[representative[c]]) {
+          targets.push_back(nfa[state].out);
+        }
+      }
+      const auto next = row(closure(std::move(targets)));
+      transitions[id * class_count + c] = next;
+    }
+  }
+  return start_row;
+}
+
+} // namespace
+
+byte_regex::byte_regex(std::string_view pattern, std::size_t max_match_size)
+    : max_match_size_{max_match_size} {
+  if (max_match_size == 0) {
+    throw std::invalid_argument("max match size cannot be 0");
+  }
+  const auto tree = regex_parser{pattern}.parse();
+
+  // split the bytes into classes no set of the regex tells apart
+  std::vector<byte_set> sets{};
+  collect_sets(tree, sets);
+  this->class_count_ = 1;
+  for (const auto &set : sets) {
+    std::vector<std::uint16_t> split(this->class_count_ * 2, 0xffff);
+    std::size_t count = 0;
+    for (std::size_t b = 0; b < this->byte_class_.size(); ++b) {
+      auto &target = split[this->byte_class_[b] * 2u + (set[b] ? 1 : 0)];
+      if (target == 0xffff) {
+        target = static_cast<std::uint16_t>(count++);
+      }
+      this->byte_class_[b] = target;
+    }
+    this->class_count_ = count;
+  }
+
+  nfa_builder forward{false};
+  const auto start = forward.compile(tree, 0);
+  this->anchored_.start =
+      build_dfa(forward.states(), start, this->byte_class_, this->class_count_,
+                match_flag, this->anchored_.transitions);
+  if ((this->anchored_.start & match_flag) != 0) {
+    throw std::invalid_argument(
+        std::format("regex matches the empty string: {}", pattern));
+  }
+  this->forward_.start = build_dfa(
+      forward.states(), forward.unanchored(start), this->byte_class_,
+      this->class_count_, match_flag, this->forward_.transitions);
+
+  nfa_builder reverse{true};
+  const auto reverse_start = reverse.unanchored(reverse.compile(tree, 0));
+  this->reverse_.start =
+      build_dfa(reverse.states(), reverse_start, this->byte_class_,
+                this->class_count_, match_flag, this->reverse_.transitions);
+}
+
+[[nodiscard]] std::size_t byte_regex::max_match_size() const noexcept {
+  return this->max_match_size_;
+}
+
+[[nodiscard]] std::pair<std::size_t, std::size_t>
+byte_regex::find(std::span<const std::byte> haystack, std::size_t from) const {
+  const auto size = haystack.size();
+  const auto step = [this](const dfa &automaton, std::uint32_t state,
+                           std::byte byte) {
+    return automaton.transitions[(state & ~match_flag) +
+                                 this->byte_class_[std::to_integer<std::size_t>(
+                                     byte)]];
+  };
+
+  while (from < size) {
+    // the first position any match ends at
+    auto state = this->forward_.start;
+    auto end = from;
+    while (end < size && (state & match_flag) == 0) {
+      state = step(this->forward_, state, haystack[end]);
+      ++end;
+    }
+    if ((state & match_flag) == 0) {
+      break;
+    }
+
+    // every match still in progress there ends at or before the last
+    // accepting position the forward dfa passes before it is back at its
+    // start state, where no match is in progress
+    const auto limit = end + std::min(size - end, this->max_match_size_);
+    auto high = end;
+    for (auto i = end; i < limit && state != this->forward_.start; ++i) {
+      state = step(this->forward_, state, haystack[i]);
+      if ((state & match_flag) != 0) {
+        high = i + 1;
+      }
+    }
+
+    // the leftmost match start from there, matches overlapping the previous
+    // one are not considered. no match ends before end, so once the reverse
+    // dfa is back at its start state left of it no match can start further
+    // left.
+    const auto low = end - std::min(end - from, this->max_match_size_);
+    auto start = end;
+    state = this->reverse_.start;
+    for (auto i = high; i > low; --i) {
+      state = step(this->reverse_, state, haystack[i - 1]);
+      if ((state & match_flag) != 0) {
+        start = i - 1;
+      } else if (i - 1 < end && state == this->reverse_.start) {
+        break;
+      }
+    }
+
+    // and the longest match from that start
+    auto match_end = start;
+    state = this->anchored_.start;
+    for (auto i = start; i < high; ++i) {
+      state = step(this->anchored_, state, haystack[i]);
+      if (state == 0) {
+        break;
+      }
+      if ((state & match_flag) != 0) {
+        match_end = i + 1;
+      }
+    }
+    if (match_end != start) {
+      return {start, match_end - start};
+    }
+    // the match ending first is longer than max_match_size_
+    from = end;
+  }
+  return {size, 0};
+}
+
+} // namespace pp
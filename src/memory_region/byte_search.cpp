@@ -0,0 +1,187 @@
+#include "memory_region/byte_search.hpp"
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+
+#ifdef __x86_64__
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+namespace pp {
+
+namespace {
+
+// compares everything between the first and the last byte, both of which the
+// callers already checked
+[[nodiscard]] bool matches_inner(const std::byte *candidate,
+                                 const std::byte *needle,
+                                 std::size_t size) noexcept {
+  return size <= 2 || std::memcmp(candidate + 1, needle + 1, size - 2) == 0;
+}
+
+[[nodiscard]] std::size_t find_scalar(const std::byte *haystack,
+                                      std::size_t haystack_size,
+                                      const std::byte *needle,
+                                      std::size_t size) noexcept {
+  const auto first = std::to_integer<int>(needle[0]);
+  const auto last = needle[size - 1];
+  const auto *current = haystack;
+  const auto *const end = haystack + (haystack_size - size + 1);
+  while (current < end) {
+    current = static_cast<const std::byte *>(std::memchr(
+        current, first, static_cast<std::size_t>(end - current)));
+    if (current == nullptr) {
+      return haystack_size;
+    }
+    if (current[size - 1] == last && matches_inner(current, needle, size)) {
+      return static_cast<std::size_t>(current - haystack);
+    }
+    ++current;
+  }
+  return haystack_size;
+}
+
+#ifdef __x86_64__
+
+[[nodiscard]] __attribute__((target("avx2"))) std::size_t
+find_avx2(const std::byte *haystack, std::size_t haystack_size,
+          const std::byte *needle, std::size_t size) noexcept {
+  const auto first = _mm256_set1_epi8(static_cast<char>(needle[0]));
+  const auto last = _mm256_set1_epi8(static_cast<char>(needle[size - 1]));
+  std::size_t i = 0;
+  for (; i + size - 1 + 32 <= haystack_size; i += 32) {
+    const auto block_first =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(haystack + i));
+    const auto block_last = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i *>(haystack + i + size - 1));
+    auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(
+        _mm256_and_si256(_mm256_cmpeq_epi8(first, block_first),
+                         _mm256_cmpeq_epi8(last, block_last))));
+    while (mask != 0) {
+      const auto bit = static_cast<std::size_t>(std::countr_zero(mask));
+      if (matches_inner(haystack + i + bit, needle, size)) {
+        return i + bit;
+      }
+      mask &= mask - 1;
+    }
+  }
+  const auto rest = find_scalar(haystack + i, haystack_size - i, needle, size);
+  return rest == haystack_size - i ? haystack_size : i + rest;
+}
+
+[[nodiscard]] __attribute__((target("sse4.2"))) std::size_t
+find_sse42(const std::byte *haystack, std::size_t haystack_size,
+           const std::byte *needle, std::size_t size) noexcept {
+  const auto first = _mm_set1_epi8(static_cast<char>(needle[0]));
+  const auto last = _mm_set1_epi8(static_cast<char>(needle[size - 1]));
+  const auto candidates = [&](const std::byte *block) {
+    const auto block_first =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(block));
+    const auto block_last =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(block + size - 1));
+    return static_cast<std::uint32_t>(
+        _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(first, block_first),
+                                        _mm_cmpeq_epi8(last, block_last))));
+  };
+  std::size_t i = 0;
+  for (; i + size - 1 + 32 <= haystack_size; i += 32) {
+    auto mask =
+        candidates(haystack + i) | (candidates(haystack + i + 16) << 16);
+    while (mask != 0) {
+      const auto bit = static_cast<std::size_t>(std::countr_zero(mask));
+      if (matches_inner(haystack + i + bit, needle, size)) {
+        return i + bit;
+      }
+      mask &= mask - 1;
+    }
+  }
+  const auto rest = find_scalar(haystack + i, haystack_size - i, needle, size);
+  return rest == haystack_size - i ? haystack_size : i + rest;
+}
+
+[[nodiscard]] search_kernel detect_search_kernel() noexcept {
+  std::uint32_t eax{0};
+  std::uint32_t ebx{0};
+  std::uint32_t ecx{0};
+  std::uint32_t edx{0};
+  if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) == 0) {
+    return search_kernel::SCALAR;
+  }
+  const bool sse42 = (ecx & bit_SSE4_2) != 0;
+  const bool avx = (ecx & bit_AVX) != 0 && (ecx & bit_OSXSAVE) != 0;
+  if (avx && __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) != 0 &&
+      (ebx & bit_AVX2) != 0) {
+    // the os has to save the ymm registers too
+    std::uint32_t xcr0{0};
+    std::uint32_t xcr0_high{0};
+    __asm__("xgetbv" : "=a"(xcr0), "=d"(xcr0_high) : "c"(0));
+    if ((xcr0 & 0x6) == 0x6) {
+      return search_kernel::AVX2;
+    }
+  }
+  return sse42 ? search_kernel::SSE42 : search_kernel::SCALAR;
+}
+
+#else
+
+[[nodiscard]] search_kernel detect_search_kernel() noexcept {
+  return search_kernel::SCALAR;
+}
+
+#endif
+
+} // namespace
+
+[[nodiscard]] std::string_view search_kernel_to_str(search_kernel kernel) {
+  switch (kernel) {
+  case search_kernel::SCALAR:
+    return "scalar";
+  case search_kernel::SSE42:
+    return "sse4.2";
+  case search_kernel::AVX2:
+    return "avx2";
+  }
+  return "unknown";
+}
+
+[[nodiscard]] search_kernel active_search_kernel() noexcept {
+  static const auto kernel = detect_search_kernel();
+  return kernel;
+}
+
+[[nodiscard]] std::size_t
+find_bytes(std::span<const std::byte> haystack,
+           std::span<const std::byte> needle) noexcept {
+  return find_bytes(haystack, needle, active_search_kernel());
+}
+
+[[nodiscard]] std::size_t find_bytes(std::span<const std::byte> haystack,
+                                     std::span<const std::byte> needle,
+                                     search_kernel kernel) noexcept {
+  if (needle.empty()) {
+    return 0;
+  }
+  if (needle.size() > haystack.size()) {
+    return haystack.size();
+  }
+#ifdef __x86_64__
+  switch (kernel) {
+  case search_kernel::AVX2:
+    return find_avx2(haystack.data(), haystack.size(), needle.data(),
+                     needle.size());
+  case search_kernel::SSE42:
+    return find_sse42(haystack.data(), haystack.size(), needle.data(),
+                      needle.size());
+  case search_kernel::SCALAR:
+    break;
+  }
+#else
+  static_cast<void>(kernel);
+#endif
+  return find_scalar(haystack.data(), haystack.size(), needle.data(),
+                     needle.size());
+}
+
+} // namespace pp
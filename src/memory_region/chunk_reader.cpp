@@ -0,0 +1,88 @@
+#include "memory_region/chunk_reader.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace pp {
+
+buffer_pool::lease::lease(lease &&other) noexcept
+    : pool_{std::exchange(other.pool_, nullptr)},
+      data_{std::exchange(other.data_, nullptr)} {}
+
+buffer_pool::lease &buffer_pool::lease::operator=(lease &&other) noexcept {
+  if (this != &other) {
+    if (this->pool_ != nullptr) {
+      this->pool_->release(this->data_);
+    }
+    this->pool_ = std::exchange(other.pool_, nullptr);
+    this->data_ = std::exchange(other.data_, nullptr);
+  }
+  return *this;
+}
+
+buffer_pool::lease::~lease() noexcept {
+  if (this->pool_ != nullptr) {
+    this->pool_->release(this->data_);
+  }
+}
+
+[[nodiscard]] std::span<std::byte> buffer_pool::lease::bytes() const noexcept {
+  if (this->pool_ == nullptr) {
+    return {};
+  }
+  return {this->data_, this->pool_->buffer_size()};
+}
+
+buffer_pool::buffer_pool(std::size_t count, std::size_t buffer_size)
+    : buffer_size_{buffer_size}, count_{std::max<std::size_t>(count, 1)} {
+  this->buffers_.reserve(this->count_);
+  this->free_.reserve(this->count_);
+}
+
+[[nodiscard]] std::size_t buffer_pool::buffer_size() const noexcept {
+  return this->buffer_size_;
+}
+
+[[nodiscard]] buffer_pool::lease buffer_pool::acquire() {
+  std::unique_lock lock{this->mutex_};
+  if (this->free_.empty() && this->buffers_.size() < this->count_) {
+    this->buffers_.push_back(
+        std::make_unique_for_overwrite<std::byte[]>(this->buffer_size_));
+    return {*this, this->buffers_.back().get()};
+  }
+  this->released_.wait(lock, [this] { return !this->free_.empty(); });
+  auto *buffer = this->free_.back();
+  this->free_.pop_back();
+  return {*this, buffer};
+}
+
+void buffer_pool::release(std::byte *buffer) noexcept {
+  {
+    const std::lock_guard lock{this->mutex_};
+    this->free_.push_back(buffer);
+  }
+  this->released_.notify_one();
+}
+
+[[nodiscard]] std::vector<scan_chunk>
+split_into_chunks(std::span<const memory_region> regions,
+                  std::size_t chunk_size, std::size_t overlap) {
+  std::vector<scan_chunk> chunks{};
+  chunk_size = std::max<std::size_t>(chunk_size, 1);
+  for (std::size_t i = 0; i < regions.size(); ++i) {
+    const auto &region = regions[i];
+    const auto region_end = region.begin() + region.size();
+    for (auto begin = region.begin(); begin < region_end;
+         begin += chunk_size) {
+      const auto size = std::min(chunk_size, region_end - begin);
+      chunks.push_back({.region = i,
+                        .begin = begin,
+                        .size = size,
+                        .overlap =
+                            std::min(overlap, region_end - (begin + size))});
+    }
+  }
+  return chunks;
+}
+
+} // namespace pp
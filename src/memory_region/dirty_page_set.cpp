@@ -0,0 +1,164 @@
+#include "memory_region/dirty_page_set.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <format>
+#include <stdexcept>
+#include <system_error>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#else
+#error "only linux is supported"
+#endif
+
+namespace pp {
+
+namespace {
+
+// pagemap entries looked up with one pread, bounds the memory of a lookup
+constexpr std::size_t max_lookup_pages = 64 * 1024;
+
+[[nodiscard]] std::size_t page_size() {
+  static const auto size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+  return size;
+}
+
+// without CONFIG_MEM_SOFT_DIRTY clear_refs accepts "4" but the bit is never
+// set, which would look like nothing was ever written. a page we just wrote
+// to ourselves has it set on kernels that track it.
+[[nodiscard]] bool detect_soft_dirty() {
+  const auto size = page_size();
+  auto *const page = static_cast<char *>(mmap(nullptr, size,
+                                              PROT_READ | PROT_WRITE,
+                                              MAP_PRIVATE | MAP_ANONYMOUS, -1,
+                                              0));
+  if (page == MAP_FAILED) {
+    return false;
+  }
+  *static_cast<volatile char *>(page) = 1;
+  bool supported = false;
+  try {
+    const page_map pages{process{static_cast<std::uint32_t>(getpid())}};
+    supported = pages.soft_dirty_pages(reinterpret_cast<std::uintptr_t>(page),
+                                       size)
+                    .front();
+  } catch (const std::system_error &) {
+  }
+  munmap(page, size);
+  return supported;
+}
+
+} // namespace
+
+dirty_page_set::dirty_page_set(const process &proc)
+    : proc_{proc}, pages_{proc} {
+  static const auto supported = detect_soft_dirty();
+  if (!supported) {
+    throw std::runtime_error(
+        "soft-dirty page tracking is not supported by this kernel");
+  }
+}
+
+void dirty_page_set::reset() const {
+  const auto path = std::format("/proc/{}/clear_refs", this->proc_.pid());
+  const auto fd = open(path.c_str(), O_WRONLY | O_CLOEXEC);
+  if (fd == -1) {
+    throw std::system_error(errno, std::generic_category(),
+                            std::format("unable to open file: {}", path));
+  }
+  // 4 clears the soft-dirty bits only, the other values reset the
+  // referenced bits the kernel uses for reclaim
+  const auto written = write(fd, "4", 1);
+  const auto error = errno;
+  close(fd);
+  if (written != 1) {
+    throw std::system_error(error, std::generic_category(),
+                            std::format("unable to write file: {}", path));
+  }
+}
+
+[[nodiscard]] std::vector<bool>
+dirty_page_set::dirty_pages(std::span<const std::uintptr_t> pages) const {
+  std::vector<bool> dirty(pages.size());
+  // addresses close to each other share one lookup
+  std::size_t begin = 0;
+  while (begin < pages.size()) {
+    const auto first = pages[begin] / page_size();
+    auto end = begin + 1;
+    while (end < pages.size() && pages[end] / page_size() >= first &&
+           pages[end] / page_size() - first < max_lookup_pages) {
+      ++end;
+    }
+    const auto last = std::ranges::max(pages.subspan(begin, end - begin)) /
+                      page_size();
+    const auto bits = this->pages_.soft_dirty_pages(
+        first * page_size(), (last - first + 1) * page_size());
+    for (auto i = begin; i < end; ++i) {
+      dirty[i] = bits[pages[i] / page_size() - first];
+    }
+    begin = end;
+  }
+  return dirty;
+}
+
+[[nodiscard]] std::vector<memory_region>
+dirty_page_set::dirty_regions(std::span<const memory_region> regions) const {
+  std::vector<memory_region> dirty{};
+  for (const auto &region : regions) {
+    const auto region_end = region.begin() + region.size();
+    std::uintptr_t run_begin = 0;
+    std::uintptr_t run_end = 0;
+    const auto flush = [&] {
+      if (run_end != run_begin) {
+        dirty.emplace_back(run_begin, run_end - run_begin,
+                           region.permissions(), region.name());
+      }
+      run_begin = run_end = 0;
+    };
+    for (auto window = region.begin(); window < region_end;
+         window += max_lookup_pages * page_size()) {
+      const auto size =
+          std::min(region_end - window, max_lookup_pages * page_size());
+      const auto bits = this->pages_.soft_dirty_pages(window, size);
+      for (std::size_t i = 0; i < bits.size(); ++i) {
+        const auto page_begin = window + i * page_size();
+        const auto page_end = std::min(page_begin + page_size(), region_end);
+        if (!bits[i]) {
+          flush();
+        } else if (run_end == page_begin && run_end != 0) {
+          run_end = page_end;
+        } else {
+          run_begin = page_begin;
+          run_end = page_end;
+        }
+      }
+    }
+    flush();
+  }
+  return dirty;
+}
+
+[[nodiscard]] std::vector<memory_region>
+dirty_page_set::dirty_regions() const {
+  const auto regions = this->proc_.memory_regions();
+  return this->dirty_regions(regions);
+}
+
+[[nodiscard]] std::vector<bool>
+dirty_page_set::take_dirty_pages(std::span<const std::uintptr_t> pages) const {
+  auto dirty = this->dirty_pages(pages);
+  this->reset();
+  return dirty;
+}
+
+[[nodiscard]] std::vector<memory_region> dirty_page_set::take_dirty_regions(
+    std::span<const memory_region> regions) const {
+  auto dirty = this->dirty_regions(regions);
+  this->reset();
+  return dirty;
+}
+
+} // namespace pp
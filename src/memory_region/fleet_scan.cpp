@@ -0,0 +1,18 @@
+#include "memory_region/fleet_scan.hpp"
+
+#include <algorithm>
+#include <thread>
+
+namespace pp {
+
+[[nodiscard]] fleet_budget split_thread_budget(std::size_t threads,
+                                               std::size_t processes) {
+  const auto budget =
+      threads != 0
+          ? threads
+          : std::max<std::size_t>(1, std::thread::hardware_concurrency());
+  const auto concurrent = std::clamp<std::size_t>(processes, 1, budget);
+  return {.concurrent = concurrent, .threads_per_scan = budget / concurrent};
+}
+
+} // namespace pp
@@ -0,0 +1,301 @@
+#include "memory_region/mem_backend.hpp"
+#include "memory_region/backend_calibration.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <format>
+#include <stdexcept>
+#include <string>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/ptrace.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#else
+#error "only linux is supported"
+#endif
+
+namespace pp {
+
+namespace {
+
+// -1 while nothing is selected
+constexpr int no_backend = -1;
+
+[[nodiscard]] int initial_mem_backend() noexcept {
+  const auto *const env = std::getenv("PP_MEM_BACKEND");
+  if (env == nullptr) {
+    return no_backend;
+  }
+  const auto backend = str_to_mem_backend(env);
+  if (!backend ||
+      (*backend == mem_backend::IO_URING && !io_uring_supported())) {
+    return no_backend;
+  }
+  return static_cast<int>(*backend);
+}
+
+[[nodiscard]] std::atomic<int> &selected_backend() noexcept {
+  static std::atomic<int> backend{initial_mem_backend()};
+  return backend;
+}
+
+// the timings of the last `pp calibrate`, read once
+[[nodiscard]] const std::vector<backend_timing> &saved_timings() noexcept {
+  static const auto timings = []() -> std::vector<backend_timing> {
+    try {
+      return load_calibration(calibration_path());
+    } catch (const std::exception &) {
+      return {};
+    }
+  }();
+  return timings;
+}
+
+// /proc/<id>/mem of the last id this thread talked to, kept open so small
+// transfers do not pay for an open each
+class mem_file {
+  std::uint32_t id_{0};
+  int fd_{-1};
+
+public:
+  mem_file() = default;
+  mem_file(const mem_file &other) = delete;
+  mem_file &operator=(const mem_file &other) = delete;
+  ~mem_file() {
+    if (this->fd_ != -1) {
+      ::close(this->fd_);
+    }
+  }
+
+  [[nodiscard]] std::expected<int, std::error_code> get(std::uint32_t id) {
+    if (this->fd_ != -1 && this->id_ == id) {
+      return this->fd_;
+    }
+    const auto path = std::format("/proc/{}/mem", id);
+    auto fd = open(path.c_str(), O_RDWR | O_CLOEXEC);
+    if (fd == -1) {
+      fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    }
+    if (fd == -1) {
+      return std::unexpected{std::error_code{errno, std::generic_category()}};
+    }
+    if (this->fd_ != -1) {
+      ::close(this->fd_);
+    }
+    this->id_ = id;
+    this->fd_ = fd;
+    return fd;
+  }
+};
+
+[[nodiscard]] mem_file &thread_mem_file() noexcept {
+  thread_local mem_file file{};
+  return file;
+}
+
+// an unmapped or unwritable address fails a process_vm transfer with EFAULT
+// and a /proc/<pid>/mem or ptrace transfer with EIO once nothing went
+// through, both mean the transfer stopped at the first byte
+[[nodiscard]] std::expected<std::size_t, std::error_code>
+transferred(ssize_t result) {
+  if (result >= 0) {
+    return static_cast<std::size_t>(result);
+  }
+  if (errno == EFAULT || errno == EIO) {
+    return 0;
+  }
+  return std::unexpected{std::error_code{errno, std::generic_category()}};
+}
+
+constexpr std::size_t word_size = sizeof(long);
+
+// the word holding address, aligned down
+[[nodiscard]] std::uintptr_t word_of(std::uintptr_t address) noexcept {
+  return address & ~(word_size - 1);
+}
+
+[[nodiscard]] std::expected<std::size_t, std::error_code>
+ptrace_read(std::uint32_t id, std::uintptr_t address,
+            std::span<std::byte> out) {
+  std::size_t done = 0;
+  while (done < out.size()) {
+    const auto word = word_of(address + done);
+    errno = 0;
+    const auto value =
+        ptrace(PTRACE_PEEKDATA, static_cast<pid_t>(id), word, nullptr);
+    if (errno != 0) {
+      const auto stopped = transferred(-1);
+      return stopped ? std::expected<std::size_t, std::error_code>{done}
+                     : stopped;
+    }
+    const auto skip = address + done - word;
+    const auto count = std::min(word_size - skip, out.size() - done);
+    std::memcpy(out.data() + done,
+                reinterpret_cast<const std::byte *>(&value) + skip, count);
+    done += count;
+  }
+  return done;
+}
+
+// words only partly covered by data are read first so the bytes around it
+// are written back unchanged
+[[nodiscard]] std::expected<std::size_t, std::error_code>
+ptrace_write(std::uint32_t id, std::uintptr_t address,
+             std::span<const std::byte> data) {
+  std::size_t done = 0;
+  while (done < data.size()) {
+    const auto word = word_of(address + done);
+    const auto skip = address + done - word;
+    const auto count = std::min(word_size - skip, data.size() - done);
+    long value = 0;
+    errno = 0;
+    if (count != word_size) {
+      value = ptrace(PTRACE_PEEKDATA, static_cast<pid_t>(id), word, nullptr);
+    }
+    if (errno == 0) {
+      std::memcpy(reinterpret_cast<std::byte *>(&value) + skip,
+                  data.data() + done, count);
+      ptrace(PTRACE_POKEDATA, static_cast<pid_t>(id), word, value);
+    }
+    if (errno != 0) {
+      const auto stopped = transferred(-1);
+      return stopped ? std::expected<std::size_t, std::error_code>{done}
+                     : stopped;
+    }
+    done += count;
+  }
+  return done;
+}
+
+} // namespace
+
+[[nodiscard]] std::string_view mem_backend_to_str(mem_backend backend) {
+  switch (backend) {
+  case mem_backend::PROCESS_VM:
+    return "process_vm";
+  case mem_backend::PROC_MEM:
+    return "proc_mem";
+  case mem_backend::IO_URING:
+    return "io_uring";
+  case mem_backend::PTRACE:
+    return "ptrace";
+  }
+  return "unknown";
+}
+
+[[nodiscard]] std::optional<mem_backend>
+str_to_mem_backend(std::string_view str) noexcept {
+  for (const auto backend : {mem_backend::PROCESS_VM, mem_backend::PROC_MEM,
+                             mem_backend::IO_URING, mem_backend::PTRACE}) {
+    if (mem_backend_to_str(backend) == str) {
+      return backend;
+    }
+  }
+  return std::nullopt;
+}
+
+[[nodiscard]] bool io_uring_supported() noexcept {
+  static const auto supported = [] {
+    io_uring_params params{};
+    const auto fd = syscall(__NR_io_uring_setup, 1, &params);
+    if (fd < 0) {
+      return false;
+    }
+    ::close(static_cast<int>(fd));
+    return true;
+  }();
+  return supported;
+}
+
+[[nodiscard]] std::optional<mem_backend> selected_mem_backend() noexcept {
+  const auto backend = selected_backend().load(std::memory_order_relaxed);
+  if (backend == no_backend) {
+    return std::nullopt;
+  }
+  return static_cast<mem_backend>(backend);
+}
+
+[[nodiscard]] mem_backend active_mem_backend() noexcept {
+  return selected_mem_backend().value_or(mem_backend::PROCESS_VM);
+}
+
+void set_mem_backend(mem_backend backend) {
+  if (backend == mem_backend::IO_URING && !io_uring_supported()) {
+    throw std::runtime_error("io_uring is not available to this process");
+  }
+  selected_backend().store(static_cast<int>(backend),
+                           std::memory_order_relaxed);
+}
+
+[[nodiscard]] mem_backend mem_backend_for(std::size_t size) noexcept {
+  if (const auto selected = selected_mem_backend()) {
+    return *selected;
+  }
+  return fastest_backend(saved_timings(), size)
+      .value_or(mem_backend::PROCESS_VM);
+}
+
+[[nodiscard]] std::expected<std::size_t, std::error_code>
+remote_read(std::uint32_t id, std::uintptr_t address,
+            std::span<std::byte> out) {
+  return remote_read(mem_backend_for(out.size()), id, address, out);
+}
+
+[[nodiscard]] std::expected<std::size_t, std::error_code>
+remote_read(mem_backend backend, std::uint32_t id, std::uintptr_t address,
+            std::span<std::byte> out) {
+  if (backend == mem_backend::PROCESS_VM) {
+    iovec local{.iov_base = out.data(), .iov_len = out.size()};
+    iovec remote{.iov_base = reinterpret_cast<void *>(address),
+                 .iov_len = out.size()};
+    return transferred(process_vm_readv(static_cast<std::int32_t>(id), &local,
+                                        1, &remote, 1, 0));
+  }
+  if (backend == mem_backend::PTRACE) {
+    return ptrace_read(id, address, out);
+  }
+  const auto fd = thread_mem_file().get(id);
+  if (!fd) {
+    return std::unexpected{fd.error()};
+  }
+  return transferred(
+      pread(*fd, out.data(), out.size(), static_cast<off_t>(address)));
+}
+
+[[nodiscard]] std::expected<std::size_t, std::error_code>
+remote_write(std::uint32_t id, std::uintptr_t address,
+             std::span<const std::byte> data) {
+  return remote_write(active_mem_backend(), id, address, data);
+}
+
+[[nodiscard]] std::expected<std::size_t, std::error_code>
+remote_write(mem_backend backend, std::uint32_t id, std::uintptr_t address,
+             std::span<const std::byte> data) {
+  if (backend == mem_backend::PROCESS_VM) {
+    iovec local{.iov_base = const_cast<void *>(
+                    reinterpret_cast<const void *>(data.data())),
+                .iov_len = data.size()};
+    iovec remote{.iov_base = reinterpret_cast<void *>(address),
+                 .iov_len = data.size()};
+    return transferred(process_vm_writev(static_cast<std::int32_t>(id), &local,
+                                         1, &remote, 1, 0));
+  }
+  if (backend == mem_backend::PTRACE) {
+    return ptrace_write(id, address, data);
+  }
+  const auto fd = thread_mem_file().get(id);
+  if (!fd) {
+    return std::unexpected{fd.error()};
+  }
+  return transferred(
+      pwrite(*fd, data.data(), data.size(), static_cast<off_t>(address)));
+}
+
+} // namespace pp
@@ -0,0 +1,171 @@
+#include "memory_region/memory_dump.hpp"
+#include "memory_region/memio.hpp"
+#include "memory_region/page_map.hpp"
+#include "memory_region/scanner.hpp"
+#include "util/work_stealing_pool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <format>
+#include <fstream>
+#include <optional>
+#include <system_error>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#else
+#error "only linux is supported"
+#endif
+
+namespace pp {
+
+namespace {
+
+// the dump file, sized and mapped shared for as long as it is written
+class dump_file {
+  int fd_{-1};
+  std::byte *data_{nullptr};
+  std::size_t size_{0};
+
+public:
+  dump_file(const std::filesystem::path &path, std::size_t size)
+      : size_{size} {
+    this->fd_ = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC,
+                     0644);
+    if (this->fd_ == -1) {
+      throw std::system_error(
+          errno, std::generic_category(),
+          std::format("unable to open file: {}", path.string()));
+    }
+    if (size == 0) {
+      return;
+    }
+    if (ftruncate(this->fd_, static_cast<off_t>(size)) == -1) {
+      const auto error = errno;
+      close(this->fd_);
+      throw std::system_error(
+          error, std::generic_category(),
+          std::format("unable to resize file: {}", path.string()));
+    }
+    void *data =
+        mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, this->fd_, 0);
+    if (data == MAP_FAILED) {
+      const auto error = errno;
+      close(this->fd_);
+      throw std::system_error(
+          error, std::generic_category(),
+          std::format("unable to map file: {}", path.string()));
+    }
+    this->data_ = static_cast<std::byte *>(data);
+  }
+  dump_file(const dump_file &other) = delete;
+  dump_file &operator=(const dump_file &other) = delete;
+  ~dump_file() {
+    if (this->data_ != nullptr) {
+      munmap(this->data_, this->size_);
+    }
+    close(this->fd_);
+  }
+
+  [[nodiscard]] std::span<std::byte> bytes() const noexcept {
+    return {this->data_, this->size_};
+  }
+};
+
+struct dump_chunk {
+  std::size_t region{0};
+  // from the start of the region
+  std::size_t offset{0};
+  std::size_t size{0};
+};
+
+void write_index(const std::filesystem::path &path,
+                 std::span<const dumped_region> regions) {
+  std::ofstream file{path, std::ios_base::trunc};
+  if (!file.is_open()) {
+    throw std::filesystem::filesystem_error(
+        std::format("unable to open file: {}", path.string()),
+        std::error_code());
+  }
+  for (const auto &[region, offset, read] : regions) {
+    file << std::format("{:x}-{:x} {} {:x} {:x} {}\n", region.begin(),
+                        region.begin() + region.size(),
+                        permission_to_str(region.permissions()), offset, read,
+                        region.name().value_or("[anonymous]"));
+  }
+}
+
+} // namespace
+
+dump_report dump_memory(const process &proc,
+                        std::span<const memory_region> regions,
+                        const std::filesystem::path &path,
+                        const dump_options &options) {
+  dump_report report{};
+  std::vector<dump_chunk> chunks{};
+  const auto chunk_size = std::max<std::size_t>(options.chunk_size, 1);
+  for (std::size_t i = 0; i < regions.size(); ++i) {
+    report.regions.push_back(
+        {.region = regions[i], .offset = report.size, .read = 0});
+    for (std::size_t offset = 0; offset < regions[i].size();
+         offset += chunk_size) {
+      chunks.push_back(
+          {.region = i,
+           .offset = offset,
+           .size = std::min(chunk_size, regions[i].size() - offset)});
+    }
+    report.size += regions[i].size();
+  }
+
+  {
+    const dump_file file{path, report.size};
+    const auto bytes = file.bytes();
+    // bytes read per chunk, summed per region afterwards
+    std::vector<std::size_t> read(chunks.size());
+    std::atomic<bool> gone{false};
+    const work_stealing_pool pool{options.threads};
+    std::optional<page_map> pages{};
+    if (!options.include_swapped) {
+      pages.emplace(proc);
+    }
+    std::vector<scan_stats> stats(pool.size());
+    pool.run(chunks.size(), [&](std::size_t worker, std::size_t task) {
+      if (gone.load(std::memory_order_relaxed)) {
+        return;
+      }
+      const auto &chunk = chunks[task];
+      const auto &dumped = report.regions[chunk.region];
+      const auto ranges = read_resident_ranges(
+          proc, pages ? &*pages : nullptr, dumped.region.begin() + chunk.offset,
+          bytes.subspan(dumped.offset + chunk.offset, chunk.size), chunk.size,
+          stats[worker]);
+      if (!ranges) {
+        gone.store(true, std::memory_order_relaxed);
+        throw std::system_error(
+            ranges.error(),
+            std::format("failed to dump memory beginning at: {:x}",
+                        dumped.region.begin() + chunk.offset));
+      }
+      for (const auto &range : *ranges) {
+        read[task] += range.size;
+      }
+    });
+    for (std::size_t i = 0; i < chunks.size(); ++i) {
+      report.regions[chunks[i].region].read += read[i];
+      report.read += read[i];
+    }
+    for (const auto &worker_stats : stats) {
+      report.pages_skipped += worker_stats.pages_skipped;
+    }
+  }
+
+  auto index = path;
+  index += ".index";
+  write_index(index, report.regions);
+  return report;
+}
+
+} // namespace pp
@@ -0,0 +1,182 @@
+#include "memory_region/numa.hpp"
+#include "util/read_file.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <format>
+#include <ranges>
+#include <sstream>
+#include <system_error>
+
+namespace pp {
+
+namespace {
+
+// "0-3,8-11" as in /sys/devices/system/node
+[[nodiscard]] std::vector<std::size_t> parse_id_list(std::string_view text) {
+  std::vector<std::size_t> ids{};
+  for (const auto part : std::views::split(text, ',')) {
+    const std::string_view range{part.begin(), part.end()};
+    std::size_t first{0};
+    const auto *end = range.data() + range.size();
+    auto result = std::from_chars(range.data(), end, first);
+    if (result.ec != std::errc{}) {
+      continue;
+    }
+    auto last = first;
+    if (result.ptr != end && *result.ptr == '-') {
+      result = std::from_chars(result.ptr + 1, end, last);
+      if (result.ec != std::errc{}) {
+        continue;
+      }
+    }
+    for (auto id = first; id <= last; ++id) {
+      ids.push_back(id);
+    }
+  }
+  return ids;
+}
+
+} // namespace
+
+[[nodiscard]] std::optional<std::size_t> numa_region::home_node() const {
+  const auto most = std::ranges::max_element(this->pages);
+  if (most == this->pages.end() || *most == 0) {
+    return std::nullopt;
+  }
+  return static_cast<std::size_t>(most - this->pages.begin());
+}
+
+[[nodiscard]] std::vector<std::size_t> online_numa_nodes() {
+  try {
+    auto nodes = parse_id_list(read_file("/sys/devices/system/node/online"));
+    if (!nodes.empty()) {
+      return nodes;
+    }
+  } catch (const std::system_error &) {
+    // no numa support in the kernel
+  }
+  return {0};
+}
+
+[[nodiscard]] std::vector<numa_region> numa_placement(const process &proc) {
+  std::string contents;
+  try {
+    contents = read_file(std::format("/proc/{}/numa_maps", proc.pid()));
+  } catch (const std::system_error &) {
+    return {};
+  }
+  // 7f0000000000 default anon=3 dirty=3 N0=2 N1=1 kernelpagesize_kB=4
+  std::vector<numa_region> regions{};
+  std::istringstream lines{contents};
+  std::string line;
+  while (std::getline(lines, line)) {
+    std::istringstream fields{line};
+    std::string address;
+    numa_region region{};
+    if (!(fields >> address >> region.policy)) {
+      continue;
+    }
+    region.begin = std::stoull(address, nullptr, 16);
+    std::string field;
+    while (fields >> field) {
+      const auto eq = field.find('=');
+      if (eq == std::string::npos) {
+        continue;
+      }
+      // file=, anon=, dirty=, ... are left out
+      const auto key = std::string_view{field}.substr(0, eq);
+      const auto is_node =
+          key.size() > 1 && key.front() == 'N' &&
+          std::ranges::all_of(key.substr(1), [](unsigned char c) {
+            return std::isdigit(c) != 0;
+          });
+      if (is_node) {
+        const auto node = std::stoull(std::string{key.substr(1)});
+        if (region.pages.size() <= node) {
+          region.pages.resize(node + 1);
+        }
+        region.pages[node] = std::stoull(field.substr(eq + 1));
+      } else if (key == "kernelpagesize_kB") {
+        region.page_size = std::stoull(field.substr(eq + 1)) * 1024;
+      }
+    }
+    regions.push_back(std::move(region));
+  }
+  std::ranges::sort(regions, {}, &numa_region::begin);
+  return regions;
+}
+
+numa_pinning::numa_pinning(const process &proc,
+                           std::span<const memory_region> regions,
+                           std::size_t workers) {
+  const auto nodes = online_numa_nodes();
+  if (nodes.size() < 2 ||
+      sched_getaffinity(0, sizeof(this->original_), &this->original_) == -1) {
+    return;
+  }
+  const auto placement = numa_placement(proc);
+  if (placement.empty()) {
+    return;
+  }
+
+  this->node_cpus_.resize(std::ranges::max(nodes) + 1);
+  for (const auto node : nodes) {
+    std::vector<std::size_t> cpus{};
+    try {
+      cpus = parse_id_list(read_file(
+          std::format("/sys/devices/system/node/node{}/cpulist", node)));
+    } catch (const std::system_error &) {
+      continue;
+    }
+    cpu_set_t set{};
+    CPU_ZERO(&set);
+    for (const auto cpu : cpus) {
+      if (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &this->original_)) {
+        CPU_SET(cpu, &set);
+      }
+    }
+    if (CPU_COUNT(&set) > 0) {
+      this->node_cpus_[node] = set;
+    }
+  }
+
+  this->region_nodes_.resize(regions.size());
+  for (std::size_t i = 0; i < regions.size(); ++i) {
+    const auto found = std::ranges::lower_bound(placement, regions[i].begin(),
+                                                {}, &numa_region::begin);
+    if (found == placement.end() || found->begin != regions[i].begin()) {
+      continue;
+    }
+    const auto node = found->home_node();
+    if (node && *node < this->node_cpus_.size() &&
+        this->node_cpus_[*node]) {
+      this->region_nodes_[i] = node;
+    }
+  }
+  this->worker_nodes_.resize(workers);
+  this->active_ = true;
+}
+
+numa_pinning::~numa_pinning() {
+  if (this->active_) {
+    sched_setaffinity(0, sizeof(this->original_), &this->original_);
+  }
+}
+
+void numa_pinning::enter(std::size_t worker, std::size_t region) {
+  if (!this->active_) {
+    return;
+  }
+  const auto node = this->region_nodes_[region];
+  if (!node || this->worker_nodes_[worker] == node) {
+    return;
+  }
+  if (sched_setaffinity(0, sizeof(cpu_set_t), &*this->node_cpus_[*node]) ==
+      0) {
+    this->worker_nodes_[worker] = node;
+  }
+}
+
+} // namespace pp
@@ -0,0 +1,277 @@
+#include "memory_region/page_dedup.hpp"
+#include "memory_region/fleet_scan.hpp"
+#include "memory_region/page_map.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <functional>
+#include <tuple>
+#include <unordered_map>
+
+#ifdef __x86_64__
+#include <immintrin.h>
+#endif
+
+#ifdef __linux__
+#include <unistd.h>
+#else
+#error "only linux is supported"
+#endif
+
+namespace pp {
+
+namespace {
+
+constexpr std::size_t stripe_size = 32;
+constexpr std::array<std::uint64_t, 4> lane_keys{
+    0x9e37'79b9'7f4a'7c15ull, 0xc2b2'ae3d'27d4'eb4full,
+    0x1656'67b1'9e37'79f9ull, 0x27d4'eb2f'1656'67c5ull};
+// added to every lane's key after each stripe
+constexpr std::uint64_t key_step = 0x94d0'49bb'1331'11ebull;
+constexpr std::uint64_t prime = 0x9fb2'1c65'1e98'df25ull;
+
+[[nodiscard]] constexpr std::uint64_t avalanche(std::uint64_t h) noexcept {
+  h ^= h >> 33;
+  h *= 0xff51'afd7'ed55'8ccdull;
+  h ^= h >> 33;
+  h *= 0xc4ce'b9fe'1a85'ec53ull;
+  h ^= h >> 33;
+  return h;
+}
+
+// the bytes after the last full stripe and the lanes into one value
+[[nodiscard]] std::uint64_t finish(const std::array<std::uint64_t, 4> &acc,
+                                   std::span<const std::byte> tail,
+                                   std::size_t size) noexcept {
+  auto h = static_cast<std::uint64_t>(size) * prime;
+  for (const auto lane : acc) {
+    h = std::rotl(h ^ avalanche(lane), 27) * prime;
+  }
+  for (const auto byte : tail) {
+    h = (h ^ std::to_integer<std::uint64_t>(byte)) * prime;
+  }
+  return avalanche(h);
+}
+
+[[nodiscard]] std::uint64_t
+hash_page_scalar(std::span<const std::byte> page) noexcept {
+  auto acc = lane_keys;
+  auto keys = lane_keys;
+  const auto stripes = page.size() / stripe_size;
+  for (std::size_t s = 0; s < stripes; ++s) {
+    for (std::size_t lane = 0; lane < acc.size(); ++lane) {
+      std::uint64_t word{0};
+      std::memcpy(&word, page.data() + s * stripe_size + lane * 8, 8);
+      const auto keyed = word ^ keys[lane];
+      acc[lane] += word + (keyed & 0xffff'ffffull) * (keyed >> 32);
+      keys[lane] += key_step;
+    }
+  }
+  return finish(acc, page.subspan(stripes * stripe_size), page.size());
+}
+
+#ifdef __x86_64__
+
+[[nodiscard]] __attribute__((target("avx2"))) std::uint64_t
+hash_page_avx2(std::span<const std::byte> page) noexcept {
+  auto acc = _mm256_loadu_si256(
+      reinterpret_cast<const __m256i *>(lane_keys.data()));
+  auto keys = acc;
+  const auto step = _mm256_set1_epi64x(static_cast<std::int64_t>(key_step));
+  const auto stripes = page.size() / stripe_size;
+  for (std::size_t s = 0; s < stripes; ++s) {
+    const auto words = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i *>(page.data() + s * stripe_size));
+    const auto keyed = _mm256_xor_si256(words, keys);
+    // multiplies the low 32 bits of every lane, so the high half is shifted
+    // down first
+    const auto product =
+        _mm256_mul_epu32(keyed, _mm256_srli_epi64(keyed, 32));
+    acc = _mm256_add_epi64(acc, _mm256_add_epi64(words, product));
+    keys = _mm256_add_epi64(keys, step);
+  }
+  std::array<std::uint64_t, 4> lanes{};
+  _mm256_storeu_si256(reinterpret_cast<__m256i *>(lanes.data()), acc);
+  return finish(lanes, page.subspan(stripes * stripe_size), page.size());
+}
+
+#endif
+
+// one page as the scan saw it, hash is only set for exclusive pages
+struct page_hash {
+  std::uint64_t hash{0};
+  std::uint32_t region{0};
+  bool exclusive{false};
+};
+
+struct page_record {
+  std::uint64_t hash{0};
+  std::uint32_t process{0};
+  // index into the names of all regions
+  std::uint32_t name{0};
+};
+
+} // namespace
+
+[[nodiscard]] std::uint64_t
+hash_page(std::span<const std::byte> page) noexcept {
+  return hash_page(page, active_search_kernel());
+}
+
+[[nodiscard]] std::uint64_t hash_page(std::span<const std::byte> page,
+                                      search_kernel kernel) noexcept {
+#ifdef __x86_64__
+  if (kernel == search_kernel::AVX2) {
+    return hash_page_avx2(page);
+  }
+#else
+  static_cast<void>(kernel);
+#endif
+  return hash_page_scalar(page);
+}
+
+[[nodiscard]] dedup_report
+find_duplicate_pages(std::span<const process> procs,
+                     const scan_options &options) {
+  static const auto page_size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+  // hash and region index of every page of one process
+  struct process_pages {
+    std::vector<std::string> region_names{};
+    std::vector<page_hash> pages{};
+  };
+
+  const auto results = scan_fleet(
+      procs, options, [](const process &proc, const scan_options &scan) {
+        std::vector<memory_region> regions = proc.memory_regions();
+        std::erase_if(regions, [](const memory_region &region) {
+          return !region.has_permissions(permission::READ |
+                                         permission::WRITE) ||
+                 region.name() == "[vvar]" || region.name() == "[vsyscall]";
+        });
+        process_pages found{};
+        for (const auto &region : regions) {
+          found.region_names.push_back(region.name().value_or("[anonymous]"));
+        }
+        // pages already shared copy-on-write, by ksm or with another
+        // mapping free nothing when merged, they are only counted
+        const page_map pages{proc};
+        found.pages = scan_regions<page_hash>(
+            proc, regions, 0, scan,
+            [&pages](const memory_chunk &chunk, auto &out) {
+              const auto first =
+                  (page_size - chunk.address % page_size) % page_size;
+              const auto resident =
+                  pages.resident_pages(chunk.address, chunk.bytes.size());
+              const auto exclusive =
+                  pages.exclusive_pages(chunk.address, chunk.bytes.size());
+              for (auto offset = first;
+                   offset < chunk.size &&
+                   offset + page_size <= chunk.bytes.size();
+                   offset += page_size) {
+                const auto index = (chunk.address + offset) / page_size -
+                                   chunk.address / page_size;
+                // swapped in by an include_swapped scan, pagemap does not
+                // tell whether the swap slot is shared
+                if (resident[index] && !exclusive[index]) {
+                  out.push_back(
+                      {.region = static_cast<std::uint32_t>(chunk.region)});
+                  continue;
+                }
+                out.push_back(
+                    {.hash = hash_page(chunk.bytes.subspan(offset, page_size)),
+                     .region = static_cast<std::uint32_t>(chunk.region),
+                     .exclusive = true});
+              }
+            });
+        return found;
+      });
+
+  dedup_report report{};
+  std::vector<page_record> records{};
+  std::vector<std::string> names{};
+  std::unordered_map<std::string, std::uint32_t> name_ids{};
+  for (std::size_t p = 0; p < results.size(); ++p) {
+    const auto &result = results[p];
+    if (!result.result) {
+      report.failed.emplace_back(result.pid, result.result.error());
+      continue;
+    }
+    std::vector<std::uint32_t> region_ids{};
+    for (const auto &name : result.result->region_names) {
+      const auto [it, inserted] = name_ids.try_emplace(
+          name, static_cast<std::uint32_t>(names.size()));
+      if (inserted) {
+        names.push_back(name);
+      }
+      region_ids.push_back(it->second);
+    }
+    for (const auto &page : result.result->pages) {
+      if (!page.exclusive) {
+        report.shared += 1;
+        continue;
+      }
+      records.push_back({.hash = page.hash,
+                         .process = static_cast<std::uint32_t>(p),
+                         .name = region_ids[page.region]});
+    }
+  }
+  std::ranges::sort(records, [](const auto &lhs, const auto &rhs) {
+    return std::tie(lhs.hash, lhs.process, lhs.name) <
+           std::tie(rhs.hash, rhs.process, rhs.name);
+  });
+
+  const std::vector<std::byte> zero_page(page_size);
+  const auto zero_hash = hash_page(zero_page);
+  std::vector<dedup_region> regions(names.size());
+  for (std::size_t i = 0; i < names.size(); ++i) {
+    regions[i].name = names[i];
+  }
+  // shared[first * size + second] for first < second
+  std::vector<std::size_t> shared(procs.size() * procs.size());
+  std::vector<std::uint32_t> holders{};
+  for (auto begin = records.begin(); begin != records.end();) {
+    const auto end = std::find_if(begin, records.end(), [&](const auto &r) {
+      return r.hash != begin->hash;
+    });
+    const auto count = static_cast<std::size_t>(end - begin);
+    report.pages += count;
+    report.unique += 1;
+    if (begin->hash == zero_hash) {
+      report.zero += count;
+    }
+    holders.clear();
+    for (auto it = begin; it != end; ++it) {
+      regions[it->name].pages += 1;
+      if (it != begin) {
+        regions[it->name].duplicates += 1;
+      }
+      if (holders.empty() || holders.back() != it->process) {
+        holders.push_back(it->process);
+      }
+    }
+    for (std::size_t i = 0; i < holders.size(); ++i) {
+      for (std::size_t j = i + 1; j < holders.size(); ++j) {
+        ++shared[holders[i] * procs.size() + holders[j]];
+      }
+    }
+    begin = end;
+  }
+
+  std::ranges::sort(regions, std::greater{}, &dedup_region::duplicates);
+  report.regions = std::move(regions);
+  for (std::size_t i = 0; i < procs.size(); ++i) {
+    for (std::size_t j = i + 1; j < procs.size(); ++j) {
+      if (const auto pages = shared[i * procs.size() + j]; pages > 0) {
+        report.pairs.push_back({.first = procs[i].pid(),
+                                .second = procs[j].pid(),
+                                .shared = pages});
+      }
+    }
+  }
+  std::ranges::sort(report.pairs, std::greater{}, &dedup_pair::shared);
+  return report;
+}
+
+} // namespace pp
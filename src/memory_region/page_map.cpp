@@ -0,0 +1,115 @@
+#include "memory_region/page_map.hpp"
+
+#include <cerrno>
+#include <format>
+#include <system_error>
+#include <utility>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#else
+#error "only linux is supported"
+#endif
+
+namespace pp {
+
+namespace {
+
+constexpr std::uint64_t present_bit = 1ull << 63;
+constexpr std::uint64_t soft_dirty_bit = 1ull << 55;
+constexpr std::uint64_t exclusive_bit = 1ull << 56;
+
+[[nodiscard]] std::size_t page_size() {
+  static const auto size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+  return size;
+}
+
+} // namespace
+
+page_map::page_map(const process &proc) {
+  const auto path = std::format("/proc/{}/pagemap", proc.pid());
+  this->fd_ = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (this->fd_ == -1) {
+    throw std::system_error(errno, std::generic_category(),
+                            std::format("unable to open file: {}", path));
+  }
+}
+
+page_map::page_map(page_map &&other) noexcept
+    : fd_{std::exchange(other.fd_, -1)} {}
+
+page_map &page_map::operator=(page_map &&other) noexcept {
+  if (this != &other) {
+    if (this->fd_ != -1) {
+      close(this->fd_);
+    }
+    this->fd_ = std::exchange(other.fd_, -1);
+  }
+  return *this;
+}
+
+page_map::~page_map() {
+  if (this->fd_ != -1) {
+    close(this->fd_);
+  }
+}
+
+[[nodiscard]] std::vector<std::uint64_t>
+page_map::entries(std::uintptr_t address, std::size_t size) const {
+  if (size == 0) {
+    return {};
+  }
+  const auto first = address / page_size();
+  const auto last = (address + size - 1) / page_size();
+  std::vector<std::uint64_t> entries(last - first + 1);
+  const auto bytes = entries.size() * sizeof(std::uint64_t);
+  std::size_t done = 0;
+  while (done < bytes) {
+    const auto read =
+        pread(this->fd_, reinterpret_cast<char *>(entries.data()) + done,
+              bytes - done,
+              static_cast<off_t>(first * sizeof(std::uint64_t) + done));
+    if (read <= 0) {
+      throw std::system_error(
+          read == 0 ? EIO : errno, std::generic_category(),
+          std::format("failed to read pagemap entries beginning at: {:x}",
+                      address));
+    }
+    done += static_cast<std::size_t>(read);
+  }
+  return entries;
+}
+
+[[nodiscard]] std::vector<bool>
+page_map::resident_pages(std::uintptr_t address, std::size_t size) const {
+  const auto entries = this->entries(address, size);
+  std::vector<bool> resident(entries.size());
+  for (std::size_t i = 0; i < entries.size(); ++i) {
+    resident[i] = (entries[i] & present_bit) != 0;
+  }
+  return resident;
+}
+
+[[nodiscard]] std::vector<bool>
+page_map::soft_dirty_pages(std::uintptr_t address, std::size_t size) const {
+  const auto entries = this->entries(address, size);
+  std::vector<bool> dirty(entries.size());
+  for (std::size_t i = 0; i < entries.size(); ++i) {
+    dirty[i] = (entries[i] & soft_dirty_bit) != 0;
+  }
+  return dirty;
+}
+
+[[nodiscard]] std::vector<bool>
+page_map::exclusive_pages(std::uintptr_t address, std::size_t size) const {
+  const auto entries = this->entries(address, size);
+  std::vector<bool> exclusive(entries.size());
+  for (std::size_t i = 0; i < entries.size(); ++i) {
+    exclusive[i] = (entries[i] & present_bit) != 0 &&
+                   (entries[i] & exclusive_bit) != 0;
+  }
+  return exclusive;
+}
+
+} // namespace pp
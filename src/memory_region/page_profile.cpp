@@ -0,0 +1,172 @@
+#include "memory_region/page_profile.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <unordered_map>
+
+#ifdef __linux__
+#include <unistd.h>
+#else
+#error "only linux is supported"
+#endif
+
+namespace pp {
+
+namespace {
+
+// a page's worth of counts per histogram bucket, larger inputs compute
+// c * log2(c) directly
+constexpr std::size_t table_size = 4097;
+
+// c * log2(c) for every count a page's histogram bucket can hold, so the
+// entropy of a page costs no logarithms
+[[nodiscard]] const std::array<double, table_size> &c_log_c() {
+  static const auto table = [] {
+    std::array<double, table_size> values{};
+    for (std::size_t c = 1; c < values.size(); ++c) {
+      const auto count = static_cast<double>(c);
+      values[c] = count * std::log2(count);
+    }
+    return values;
+  }();
+  return table;
+}
+
+// whole words or'ed together a cache line at a time, which compilers turn
+// into vector ors, with a check per line to stop early
+[[nodiscard]] bool all_zero(std::span<const std::byte> bytes) noexcept {
+  constexpr std::size_t line = 64;
+  std::size_t offset = 0;
+  for (; offset + line <= bytes.size(); offset += line) {
+    std::array<std::uint64_t, line / 8> words{};
+    std::memcpy(words.data(), bytes.data() + offset, line);
+    std::uint64_t any = 0;
+    for (const auto word : words) {
+      any |= word;
+    }
+    if (any != 0) {
+      return false;
+    }
+  }
+  return std::ranges::all_of(bytes.subspan(offset),
+                             [](std::byte b) { return b == std::byte{0}; });
+}
+
+struct chunk_profile {
+  std::size_t region{0};
+  std::size_t zero{0};
+  std::size_t low_entropy{0};
+  std::size_t high_entropy{0};
+  double entropy{0};
+};
+
+} // namespace
+
+[[nodiscard]] double byte_entropy(std::span<const std::byte> bytes) {
+  if (bytes.empty()) {
+    return 0;
+  }
+  // four tables so consecutive bytes with the same value do not wait on each
+  // other's increment
+  std::array<std::array<std::uint32_t, 256>, 4> counts{};
+  std::size_t i = 0;
+  for (; i + 4 <= bytes.size(); i += 4) {
+    ++counts[0][std::to_integer<std::uint8_t>(bytes[i])];
+    ++counts[1][std::to_integer<std::uint8_t>(bytes[i + 1])];
+    ++counts[2][std::to_integer<std::uint8_t>(bytes[i + 2])];
+    ++counts[3][std::to_integer<std::uint8_t>(bytes[i + 3])];
+  }
+  for (; i < bytes.size(); ++i) {
+    ++counts[0][std::to_integer<std::uint8_t>(bytes[i])];
+  }
+
+  const auto &table = c_log_c();
+  double sum = 0;
+  for (std::size_t value = 0; value < 256; ++value) {
+    const std::size_t count = std::size_t{counts[0][value]} +
+                              counts[1][value] + counts[2][value] +
+                              counts[3][value];
+    if (count < table.size()) {
+      sum += table[count];
+    } else {
+      const auto c = static_cast<double>(count);
+      sum += c * std::log2(c);
+    }
+  }
+  // H = log2(n) - sum(c * log2(c)) / n
+  const auto n = static_cast<double>(bytes.size());
+  return std::max(0.0, std::log2(n) - sum / n);
+}
+
+[[nodiscard]] page_class classify_page(std::span<const std::byte> page,
+                                       double threshold) {
+  if (all_zero(page)) {
+    return page_class::ZERO;
+  }
+  return byte_entropy(page) < threshold ? page_class::LOW_ENTROPY
+                                        : page_class::HIGH_ENTROPY;
+}
+
+[[nodiscard]] std::vector<region_profile>
+profile_pages(const process &proc, std::span<const memory_region> regions,
+              double threshold, const scan_options &options) {
+  static const auto page_size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+  const auto chunks = scan_regions<chunk_profile>(
+      proc, regions, 0, options,
+      [threshold](const memory_chunk &chunk, std::vector<chunk_profile> &out) {
+        chunk_profile profile{.region = chunk.region};
+        const auto first = (page_size - chunk.address % page_size) % page_size;
+        for (auto offset = first; offset < chunk.size &&
+                                  offset + page_size <= chunk.bytes.size();
+             offset += page_size) {
+          const auto page = chunk.bytes.subspan(offset, page_size);
+          if (all_zero(page)) {
+            ++profile.zero;
+            continue;
+          }
+          const auto entropy = byte_entropy(page);
+          profile.entropy += entropy;
+          if (entropy < threshold) {
+            ++profile.low_entropy;
+          } else {
+            ++profile.high_entropy;
+          }
+        }
+        out.push_back(profile);
+      });
+
+  std::vector<region_profile> profiles{};
+  std::unordered_map<std::string, std::size_t> by_name{};
+  std::vector<std::size_t> profile_of(regions.size());
+  for (std::size_t i = 0; i < regions.size(); ++i) {
+    const auto name = regions[i].name().value_or("[anonymous]");
+    const auto [it, inserted] = by_name.try_emplace(name, profiles.size());
+    if (inserted) {
+      profiles.push_back({.name = name});
+    }
+    ++profiles[it->second].regions;
+    profile_of[i] = it->second;
+  }
+  for (const auto &chunk : chunks) {
+    auto &profile = profiles[profile_of[chunk.region]];
+    profile.zero += chunk.zero;
+    profile.low_entropy += chunk.low_entropy;
+    profile.high_entropy += chunk.high_entropy;
+    profile.resident += chunk.zero + chunk.low_entropy + chunk.high_entropy;
+    // summed up here and divided once everything is in
+    profile.entropy += chunk.entropy;
+  }
+  for (auto &profile : profiles) {
+    if (profile.resident > 0) {
+      profile.entropy /= static_cast<double>(profile.resident);
+    }
+  }
+  std::ranges::sort(profiles, std::greater{}, &region_profile::resident);
+  return profiles;
+}
+
+} // namespace pp
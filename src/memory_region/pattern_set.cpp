@@ -0,0 +1,119 @@
+#include "memory_region/pattern_set.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace pp {
+
+pattern_set::pattern_set(std::span<const std::vector<std::byte>> patterns) {
+  if (patterns.empty()) {
+    throw std::invalid_argument("pattern set cannot be empty");
+  }
+  std::array<bool, 256> used{};
+  for (const auto &pattern : patterns) {
+    if (pattern.empty()) {
+      throw std::invalid_argument("patterns cannot be empty");
+    }
+    for (const auto byte : pattern) {
+      used[std::to_integer<std::size_t>(byte)] = true;
+    }
+    this->sizes_.push_back(pattern.size());
+    this->max_size_ = std::max(this->max_size_, pattern.size());
+  }
+  // every byte used by a pattern gets its own column, the rest share column 0
+  this->class_count_ = 1;
+  for (std::size_t byte = 0; byte < used.size(); ++byte) {
+    this->byte_class_[byte] =
+        used[byte] ? static_cast<std::uint16_t>(this->class_count_++) : 0;
+  }
+  const auto columns = this->class_count_;
+
+  // trie of all patterns, children are state ids
+  constexpr auto none = std::numeric_limits<std::uint32_t>::max();
+  std::vector<std::uint32_t> trie(columns, none);
+  std::vector<std::vector<std::uint32_t>> own(1);
+  for (std::size_t i = 0; i < patterns.size(); ++i) {
+    std::size_t state = 0;
+    for (const auto byte : patterns[i]) {
+      const auto column =
+          this->byte_class_[std::to_integer<std::size_t>(byte)];
+      const auto cell = state * columns + column;
+      if (trie[cell] == none) {
+        trie[cell] = static_cast<std::uint32_t>(own.size());
+        trie.resize(trie.size() + columns, none);
+        own.emplace_back();
+      }
+      state = trie[cell];
+    }
+    own[state].push_back(static_cast<std::uint32_t>(i));
+  }
+  const auto states = own.size();
+  if (states * columns >= match_flag) {
+    throw std::length_error("pattern set is too large");
+  }
+
+  // breadth first so a state's failure target is always finished before it,
+  // missing edges are resolved through the failure links into a full dfa
+  std::vector<std::uint32_t> next(states * columns, 0);
+  std::vector<std::uint32_t> fail(states, 0);
+  std::vector<std::vector<std::uint32_t>> outputs(states);
+  std::vector<std::uint32_t> queue{};
+  queue.reserve(states);
+  for (std::size_t c = 0; c < columns; ++c) {
+    if (trie[c] != none) {
+      next[c] = trie[c];
+      queue.push_back(trie[c]);
+    }
+  }
+  for (std::size_t head = 0; head < queue.size(); ++head) {
+    const auto state = queue[head];
+    outputs[state] = own[state];
+    const auto &inherited = outputs[fail[state]];
+    outputs[state].insert(outputs[state].end(), inherited.begin(),
+                          inherited.end());
+    for (std::size_t c = 0; c < columns; ++c) {
+      const auto child = trie[state * columns + c];
+      const auto fallback = next[fail[state] * columns + c];
+      if (child == none) {
+        next[state * columns + c] = fallback;
+      } else {
+        next[state * columns + c] = child;
+        fail[child] = fallback;
+        queue.push_back(child);
+      }
+    }
+  }
+
+  this->output_begin_.reserve(states + 1);
+  for (const auto &output : outputs) {
+    this->output_begin_.push_back(
+        static_cast<std::uint32_t>(this->outputs_.size()));
+    this->outputs_.insert(this->outputs_.end(), output.begin(), output.end());
+  }
+  this->output_begin_.push_back(
+      static_cast<std::uint32_t>(this->outputs_.size()));
+
+  this->transitions_.resize(next.size());
+  for (std::size_t i = 0; i < next.size(); ++i) {
+    const auto target = next[i];
+    this->transitions_[i] =
+        static_cast<std::uint32_t>(target * columns) |
+        (outputs[target].empty() ? 0 : match_flag);
+  }
+}
+
+[[nodiscard]] std::size_t pattern_set::size() const noexcept {
+  return this->sizes_.size();
+}
+
+[[nodiscard]] std::size_t
+pattern_set::pattern_size(std::size_t pattern) const noexcept {
+  return this->sizes_[pattern];
+}
+
+[[nodiscard]] std::size_t pattern_set::max_pattern_size() const noexcept {
+  return this->max_size_;
+}
+
+} // namespace pp
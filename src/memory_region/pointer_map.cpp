@@ -0,0 +1,362 @@
+#include "memory_region/pointer_map.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <system_error>
+#include <tuple>
+#include <type_traits>
+#include <unordered_set>
+#include <utility>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#error "only linux is supported"
+#endif
+
+namespace pp {
+
+namespace {
+
+constexpr std::array<char, 8> file_magic{'P', 'P', 'P', 'T', 'R', 'M', 'A', 'P'};
+
+// file layout: header, entries sorted by value, module records and then the
+// module names back to back
+struct file_header {
+  std::array<char, 8> magic{};
+  std::uint64_t entries{0};
+  std::uint64_t modules{0};
+};
+
+struct module_record {
+  std::uint64_t begin{0};
+  std::uint64_t end{0};
+  std::uint64_t base{0};
+  std::uint64_t name_size{0};
+};
+
+static_assert(std::is_trivially_copyable_v<pointer_entry> &&
+              sizeof(pointer_entry) == 16);
+static_assert(sizeof(file_header) % alignof(pointer_entry) == 0);
+
+[[nodiscard]] bool is_readable(const memory_region &region) {
+  // the kernel's pages, which process_vm_readv cannot read
+  return region.has_permissions(permission::READ) &&
+         region.name() != "[vvar]" && region.name() != "[vsyscall]";
+}
+
+// file backed mappings keep their offset from the file's lowest mapping
+// across runs, anonymous memory, heap and stacks do not
+[[nodiscard]] std::vector<module_range>
+collect_modules(std::span<const memory_region> regions) {
+  std::map<std::string, std::uintptr_t> bases{};
+  for (const auto &region : regions) {
+    const auto name = region.name();
+    if (!name || !name->starts_with('/')) {
+      continue;
+    }
+    const auto [it, inserted] = bases.try_emplace(*name, region.begin());
+    if (!inserted) {
+      it->second = std::min(it->second, region.begin());
+    }
+  }
+  std::vector<module_range> modules{};
+  for (const auto &region : regions) {
+    const auto name = region.name();
+    if (name && bases.contains(*name)) {
+      modules.push_back({.begin = region.begin(),
+                         .end = region.begin() + region.size(),
+                         .base = bases.at(*name),
+                         .name = *name});
+    }
+  }
+  std::ranges::sort(modules, {}, &module_range::begin);
+  return modules;
+}
+
+} // namespace
+
+pointer_map::pointer_map(pointer_map &&other) noexcept
+    : owned_{std::move(other.owned_)},
+      mapping_{std::exchange(other.mapping_, nullptr)},
+      mapping_size_{std::exchange(other.mapping_size_, 0)},
+      entries_{std::exchange(other.entries_, {})},
+      modules_{std::move(other.modules_)} {}
+
+pointer_map &pointer_map::operator=(pointer_map &&other) noexcept {
+  if (this != &other) {
+    if (this->mapping_ != nullptr) {
+      munmap(this->mapping_, this->mapping_size_);
+    }
+    this->owned_ = std::move(other.owned_);
+    this->mapping_ = std::exchange(other.mapping_, nullptr);
+    this->mapping_size_ = std::exchange(other.mapping_size_, 0);
+    this->entries_ = std::exchange(other.entries_, {});
+    this->modules_ = std::move(other.modules_);
+  }
+  return *this;
+}
+
+pointer_map::~pointer_map() {
+  if (this->mapping_ != nullptr) {
+    munmap(this->mapping_, this->mapping_size_);
+  }
+}
+
+[[nodiscard]] pointer_map pointer_map::build(const process &proc,
+                                             const scan_options &options) {
+  const auto all_regions = proc.memory_regions();
+  std::vector<memory_region> regions{};
+  std::ranges::copy_if(all_regions, std::back_inserter(regions), is_readable);
+
+  // [begin, end) of the readable regions, neighbours merged, sorted
+  std::vector<std::pair<std::uintptr_t, std::uintptr_t>> targets{};
+  for (const auto &region : regions) {
+    const auto end = region.begin() + region.size();
+    if (!targets.empty() && targets.back().second == region.begin()) {
+      targets.back().second = end;
+    } else {
+      targets.emplace_back(region.begin(), end);
+    }
+  }
+  std::ranges::sort(targets);
+  const auto points_into_target = [&targets](std::uintptr_t value) {
+    if (targets.empty() || value < targets.front().first ||
+        value >= targets.back().second) {
+      return false;
+    }
+    const auto next = std::ranges::upper_bound(
+        targets, value, {},
+        &std::pair<std::uintptr_t, std::uintptr_t>::first);
+    return next != targets.begin() && value < std::prev(next)->second;
+  };
+
+  constexpr auto word = sizeof(std::uintptr_t);
+  auto entries = scan_regions<pointer_entry>(
+      proc, regions, 0, options,
+      [&](const memory_chunk &chunk, std::vector<pointer_entry> &out) {
+        // chunks start on page boundaries, this only guards odd regions
+        const auto first = (word - chunk.address % word) % word;
+        for (auto offset = first;
+             offset < chunk.size && offset + word <= chunk.bytes.size();
+             offset += word) {
+          std::uintptr_t value{0};
+          std::memcpy(&value, chunk.bytes.data() + offset, word);
+          if (points_into_target(value)) {
+            out.push_back({.value = value, .address = chunk.address + offset});
+          }
+        }
+      });
+  std::ranges::sort(entries, [](const auto &lhs, const auto &rhs) {
+    return std::tie(lhs.value, lhs.address) < std::tie(rhs.value, rhs.address);
+  });
+
+  pointer_map map{};
+  map.owned_ = std::move(entries);
+  map.entries_ = map.owned_;
+  map.modules_ = collect_modules(all_regions);
+  return map;
+}
+
+[[nodiscard]] pointer_map
+pointer_map::load(const std::filesystem::path &path) {
+  const auto fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd == -1) {
+    throw std::system_error(
+        errno, std::generic_category(),
+        std::format("unable to open file: {}", path.string()));
+  }
+  struct stat info {};
+  if (fstat(fd, &info) == -1) {
+    const auto error = errno;
+    close(fd);
+    throw std::system_error(
+        error, std::generic_category(),
+        std::format("unable to stat file: {}", path.string()));
+  }
+  const auto size = static_cast<std::size_t>(info.st_size);
+  if (size < sizeof(file_header)) {
+    close(fd);
+    throw std::runtime_error(
+        std::format("not a pointer map: {}", path.string()));
+  }
+  auto *const mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  const auto error = errno;
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    throw std::system_error(
+        error, std::generic_category(),
+        std::format("unable to map file: {}", path.string()));
+  }
+
+  pointer_map map{};
+  map.mapping_ = mapping;
+  map.mapping_size_ = size;
+  const auto *const bytes = static_cast<const char *>(mapping);
+  file_header header{};
+  std::memcpy(&header, bytes, sizeof(header));
+  const auto entries_end =
+      sizeof(header) + header.entries * sizeof(pointer_entry);
+  const auto records_end =
+      entries_end + header.modules * sizeof(module_record);
+  if (header.magic != file_magic || header.entries > size ||
+      header.modules > size || records_end > size) {
+    throw std::runtime_error(
+        std::format("not a pointer map: {}", path.string()));
+  }
+  map.entries_ = {reinterpret_cast<const pointer_entry *>(bytes +
+                                                          sizeof(header)),
+                  header.entries};
+
+  auto name_offset = records_end;
+  for (std::size_t i = 0; i < header.modules; ++i) {
+    module_record record{};
+    std::memcpy(&record, bytes + entries_end + i * sizeof(record),
+                sizeof(record));
+    if (record.name_size > size - name_offset) {
+      throw std::runtime_error(
+          std::format("truncated pointer map: {}", path.string()));
+    }
+    map.modules_.push_back({.begin = record.begin,
+                            .end = record.end,
+                            .base = record.base,
+                            .name = std::string{bytes + name_offset,
+                                                record.name_size}});
+    name_offset += record.name_size;
+  }
+  return map;
+}
+
+void pointer_map::save(const std::filesystem::path &path) const {
+  std::ofstream file{path, std::ios_base::binary | std::ios_base::trunc};
+  if (!file.is_open()) {
+    throw std::filesystem::filesystem_error(
+        std::format("unable to open file: {}", path.string()),
+        std::error_code());
+  }
+  const file_header header{.magic = file_magic,
+                           .entries = this->entries_.size(),
+                           .modules = this->modules_.size()};
+  file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  file.write(reinterpret_cast<const char *>(this->entries_.data()),
+             static_cast<std::streamsize>(this->entries_.size_bytes()));
+  for (const auto &module : this->modules_) {
+    const module_record record{.begin = module.begin,
+                               .end = module.end,
+                               .base = module.base,
+                               .name_size = module.name.size()};
+    file.write(reinterpret_cast<const char *>(&record), sizeof(record));
+  }
+  for (const auto &module : this->modules_) {
+    file.write(module.name.data(),
+               static_cast<std::streamsize>(module.name.size()));
+  }
+  if (!file.good()) {
+    throw std::filesystem::filesystem_error(
+        std::format("unable to write file: {}", path.string()),
+        std::error_code());
+  }
+}
+
+[[nodiscard]] std::span<const pointer_entry>
+pointer_map::entries() const noexcept {
+  return this->entries_;
+}
+
+[[nodiscard]] std::span<const module_range>
+pointer_map::modules() const noexcept {
+  return this->modules_;
+}
+
+[[nodiscard]] std::span<const pointer_entry>
+pointer_map::pointing_into(std::uintptr_t low,
+                           std::uintptr_t high) const noexcept {
+  const auto begin =
+      std::ranges::lower_bound(this->entries_, low, {}, &pointer_entry::value);
+  const auto end = std::ranges::upper_bound(begin, this->entries_.end(), high,
+                                            {}, &pointer_entry::value);
+  return {begin, end};
+}
+
+[[nodiscard]] const module_range *
+pointer_map::module_of(std::uintptr_t address) const noexcept {
+  const auto next = std::ranges::upper_bound(this->modules_, address, {},
+                                             &module_range::begin);
+  if (next == this->modules_.begin() || address >= std::prev(next)->end) {
+    return nullptr;
+  }
+  return &*std::prev(next);
+}
+
+[[nodiscard]] std::vector<pointer_chain>
+find_pointer_chains(const pointer_map &map, std::uintptr_t target,
+                    const chain_options &options) {
+  // an address on the way to the target, offset is what gets added to the
+  // pointer stored at address to reach the parent's address
+  struct node {
+    std::uintptr_t address{0};
+    std::size_t parent{std::numeric_limits<std::size_t>::max()};
+    std::size_t offset{0};
+  };
+
+  const auto root = node{}.parent;
+  std::vector<node> nodes{{.address = target}};
+  std::unordered_set<std::uintptr_t> visited{target};
+  std::vector<std::size_t> frontier{0};
+  std::vector<pointer_chain> chains{};
+  for (std::size_t depth = 0; depth < options.max_depth && !frontier.empty() &&
+                              chains.size() < options.max_chains;
+       ++depth) {
+    std::vector<std::size_t> next{};
+    for (const auto current : frontier) {
+      const auto wanted = nodes[current].address;
+      const auto low = wanted - std::min(wanted, options.max_offset);
+      for (const auto &entry : map.pointing_into(low, wanted)) {
+        nodes.push_back({.address = entry.address,
+                         .parent = current,
+                         .offset = wanted - entry.value});
+        const auto added = nodes.size() - 1;
+        if (const auto *const module = map.module_of(entry.address)) {
+          pointer_chain chain{.module = module->name,
+                              .offset = entry.address - module->base};
+          for (auto i = added; nodes[i].parent != root; i = nodes[i].parent) {
+            chain.offsets.push_back(nodes[i].offset);
+          }
+          chains.push_back(std::move(chain));
+          if (chains.size() >= options.max_chains) {
+            break;
+          }
+        } else if (next.size() < options.max_frontier &&
+                   visited.insert(entry.address).second) {
+          next.push_back(added);
+        }
+      }
+      if (chains.size() >= options.max_chains) {
+        break;
+      }
+    }
+    frontier = std::move(next);
+  }
+  std::ranges::sort(chains);
+  return chains;
+}
+
+[[nodiscard]] std::vector<pointer_chain>
+intersect_chains(std::span<const pointer_chain> a,
+                 std::span<const pointer_chain> b) {
+  std::vector<pointer_chain> both{};
+  std::ranges::set_intersection(a, b, std::back_inserter(both));
+  return both;
+}
+
+} // namespace pp
@@ -0,0 +1,150 @@
+#include "memory_region/scanner.hpp"
+#include "memory_region/byte_search.hpp"
+
+#include <algorithm>
+#include <system_error>
+#include <tuple>
+
+#ifdef __linux__
+#include <unistd.h>
+#else
+#error "only linux is supported"
+#endif
+
+namespace pp {
+
+[[nodiscard]] std::expected<std::vector<readable_range>, std::error_code>
+read_resident_ranges(const process &proc, const page_map *pages,
+                     std::uintptr_t address, std::span<std::byte> out,
+                     std::size_t owned, scan_stats &stats) {
+  static const auto page_size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+  const auto first_page = address / page_size;
+  const auto owned_pages = (address + owned + page_size - 1) / page_size -
+                           first_page;
+  if (pages == nullptr) {
+    stats.pages_read += owned_pages;
+    return read_memory_ranges(proc, address, out);
+  }
+
+  std::vector<bool> resident{};
+  try {
+    resident = pages->resident_pages(address, out.size());
+  } catch (const std::system_error &e) {
+    return std::unexpected{e.code()};
+  }
+  std::vector<readable_range> ranges{};
+  std::size_t page = 0;
+  while (page < resident.size()) {
+    if (!resident[page]) {
+      stats.pages_skipped += page < owned_pages ? 1 : 0;
+      ++page;
+      continue;
+    }
+    // read every run of resident pages in one go
+    auto end = page;
+    while (end < resident.size() && resident[end]) {
+      stats.pages_read += end < owned_pages ? 1 : 0;
+      ++end;
+    }
+    const auto begin_offset =
+        std::max((first_page + page) * page_size, address) - address;
+    const auto end_offset =
+        std::min((first_page + end) * page_size - address, out.size());
+    const auto run = read_memory_ranges(
+        proc, address + begin_offset,
+        out.subspan(begin_offset, end_offset - begin_offset));
+    if (!run) {
+      return std::unexpected{run.error()};
+    }
+    for (const auto &range : *run) {
+      ranges.push_back(
+          {.offset = begin_offset + range.offset, .size = range.size});
+    }
+    page = end;
+  }
+  return ranges;
+}
+
+[[nodiscard]] std::vector<std::uintptr_t>
+search_memory(const process &proc, std::span<const memory_region> regions,
+              std::span<const std::byte> pattern,
+              const scan_options &options) {
+  if (pattern.empty()) {
+    return {};
+  }
+  auto matches = scan_regions<std::uintptr_t>(
+      proc, regions, pattern.size() - 1, options,
+      [&](const memory_chunk &chunk, std::vector<std::uintptr_t> &out) {
+        auto offset = find_bytes(chunk.bytes, pattern);
+        while (offset != chunk.bytes.size()) {
+          out.push_back(chunk.address + offset);
+          offset += 1 + find_bytes(chunk.bytes.subspan(offset + 1), pattern);
+        }
+      });
+  std::ranges::sort(matches);
+  return matches;
+}
+
+[[nodiscard]] std::vector<std::uintptr_t>
+search_memory(const process &proc, std::span<const memory_region> regions,
+              const signature &sig, const scan_options &options) {
+  auto matches = scan_regions<std::uintptr_t>(
+      proc, regions, sig.size() - 1, options,
+      [&](const memory_chunk &chunk, std::vector<std::uintptr_t> &out) {
+        auto offset = sig.find(chunk.bytes);
+        while (offset != chunk.bytes.size()) {
+          out.push_back(chunk.address + offset);
+          offset += 1 + sig.find(chunk.bytes.subspan(offset + 1));
+        }
+      });
+  std::ranges::sort(matches);
+  return matches;
+}
+
+[[nodiscard]] std::vector<pattern_match>
+search_memory(const process &proc, std::span<const memory_region> regions,
+              const pattern_set &patterns, const scan_options &options) {
+  auto matches = scan_regions<pattern_match>(
+      proc, regions, patterns.max_pattern_size() - 1, options,
+      [&](const memory_chunk &chunk, std::vector<pattern_match> &out) {
+        patterns.find_all(chunk.bytes, chunk.size,
+                          [&](std::size_t pattern, std::size_t offset) {
+                            out.push_back({.pattern = pattern,
+                                           .address = chunk.address + offset});
+                          });
+      });
+  std::ranges::sort(matches, [](const pattern_match &a,
+                                const pattern_match &b) {
+    return a.address != b.address ? a.address < b.address
+                                  : a.pattern < b.pattern;
+  });
+  return matches;
+}
+
+[[nodiscard]] std::vector<regex_match>
+search_memory(const process &proc, std::span<const memory_region> regions,
+              const byte_regex &regex, const scan_options &options) {
+  auto matches = scan_regions<regex_match>(
+      proc, regions, regex.max_match_size(), options,
+      [&](const memory_chunk &chunk, std::vector<regex_match> &out) {
+        auto [offset, size] = regex.find(chunk.bytes);
+        while (offset < chunk.size) {
+          out.push_back({.address = chunk.address + offset, .size = size});
+          std::tie(offset, size) = regex.find(chunk.bytes, offset + size);
+        }
+      });
+  std::ranges::sort(matches, {}, &regex_match::address);
+
+  // a chunk can start inside a match of the previous one and report its tail
+  std::vector<regex_match> result{};
+  result.reserve(matches.size());
+  for (const auto &match : matches) {
+    if (result.empty() ||
+        match.address >= result.back().address + result.back().size) {
+      result.push_back(match);
+    }
+  }
+  return result;
+}
+
+} // namespace pp
@@ -0,0 +1,128 @@
+#include "memory_region/signature.hpp"
+#include "memory_region/byte_search.hpp"
+
+#include <cctype>
+#include <format>
+#include <stdexcept>
+#include <string>
+
+namespace pp {
+
+namespace {
+
+// value and mask of a single nibble
+[[nodiscard]] std::pair<std::uint8_t, std::uint8_t>
+parse_nibble(char c, std::string_view pattern) {
+  if (c == '?') {
+    return {0x0, 0x0};
+  }
+  if (std::isxdigit(static_cast<unsigned char>(c)) == 0) {
+    throw std::invalid_argument(
+        std::format("invalid character '{}' in signature: {}", c, pattern));
+  }
+  const auto value = std::isdigit(static_cast<unsigned char>(c)) != 0
+                         ? c - '0'
+                         : std::tolower(static_cast<unsigned char>(c)) - 'a' +
+                               10;
+  return {static_cast<std::uint8_t>(value), 0xf};
+}
+
+} // namespace
+
+signature::signature(std::string_view pattern) {
+  std::size_t pos = 0;
+  while (pos < pattern.size()) {
+    if (std::isspace(static_cast<unsigned char>(pattern[pos])) != 0) {
+      ++pos;
+      continue;
+    }
+    auto end = pos;
+    while (end < pattern.size() &&
+           std::isspace(static_cast<unsigned char>(pattern[end])) == 0) {
+      ++end;
+    }
+    auto token = pattern.substr(pos, end - pos);
+    pos = end;
+    if (token == "?") {
+      token = "??";
+    }
+    if (token.size() % 2 != 0) {
+      throw std::invalid_argument(
+          std::format("odd number of nibbles in signature: {}", pattern));
+    }
+    for (std::size_t i = 0; i < token.size(); i += 2) {
+      const auto [high, high_mask] = parse_nibble(token[i], pattern);
+      const auto [low, low_mask] = parse_nibble(token[i + 1], pattern);
+      this->bytes_.push_back(static_cast<std::byte>((high << 4) | low));
+      this->mask_.push_back(
+          static_cast<std::byte>((high_mask << 4) | low_mask));
+    }
+  }
+  if (this->bytes_.empty()) {
+    throw std::invalid_argument("signature cannot be empty");
+  }
+
+  std::size_t run_begin = 0;
+  for (std::size_t i = 0; i <= this->mask_.size(); ++i) {
+    if (i < this->mask_.size() && this->mask_[i] == std::byte{0xff}) {
+      continue;
+    }
+    if (i - run_begin > this->anchor_size_) {
+      this->anchor_offset_ = run_begin;
+      this->anchor_size_ = i - run_begin;
+    }
+    run_begin = i + 1;
+  }
+}
+
+[[nodiscard]] std::size_t signature::size() const noexcept {
+  return this->bytes_.size();
+}
+
+[[nodiscard]] bool
+signature::matches(std::span<const std::byte> bytes) const noexcept {
+  for (std::size_t i = 0; i < this->bytes_.size(); ++i) {
+    if ((bytes[i] & this->mask_[i]) != this->bytes_[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+[[nodiscard]] std::size_t
+signature::find(std::span<const std::byte> haystack) const noexcept {
+  if (haystack.size() < this->size()) {
+    return haystack.size();
+  }
+  const auto last_start = haystack.size() - this->size();
+  if (this->anchor_size_ == 0) {
+    // no fully fixed byte to look for, every offset is a candidate
+    for (std::size_t start = 0; start <= last_start; ++start) {
+      if (this->matches(haystack.subspan(start))) {
+        return start;
+      }
+    }
+    return haystack.size();
+  }
+  const auto anchor = std::span{this->bytes_}.subspan(this->anchor_offset_,
+                                                      this->anchor_size_);
+  std::size_t start = 0;
+  while (start <= last_start) {
+    // the anchor may only be found where the whole signature still fits
+    const auto window =
+        haystack.subspan(start + this->anchor_offset_,
+                         last_start - start + this->anchor_size_);
+    const auto found = find_bytes(window, anchor);
+    if (found == window.size()) {
+      break;
+    }
+    start += found;
+    if (this->matches(haystack.subspan(start))) {
+      return start;
+    }
+    ++start;
+  }
+  return haystack.size();
+}
+
+} // namespace pp
@@ -0,0 +1,240 @@
+#include "memory_region/string_scan.hpp"
+#include "memory_region/memio.hpp"
+#include "memory_region/page_map.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <numeric>
+#include <optional>
+#include <system_error>
+
+#ifdef __x86_64__
+#include <immintrin.h>
+#endif
+
+namespace pp {
+
+namespace {
+
+// one bit per byte, bit i of the mask is bit i % 64 of word i / 64
+using bitmask = std::vector<std::uint64_t>;
+
+// bytes a string crossing a chunk boundary is followed into the next chunk
+constexpr std::size_t boundary_overlap = 4096;
+
+constexpr std::uint64_t even_bits = 0x5555'5555'5555'5555ull;
+constexpr std::uint64_t odd_bits = ~even_bits;
+
+[[nodiscard]] bool is_printable(std::byte byte) noexcept {
+  const auto c = std::to_integer<unsigned char>(byte);
+  return (c >= 0x20 && c <= 0x7e) || c == '\t';
+}
+
+void classify_scalar(std::span<const std::byte> bytes, std::size_t begin,
+                     bitmask &printable, bitmask &zero) {
+  for (auto i = begin; i < bytes.size(); ++i) {
+    const auto bit = 1ull << (i % 64);
+    if (is_printable(bytes[i])) {
+      printable[i / 64] |= bit;
+    } else if (bytes[i] == std::byte{0}) {
+      zero[i / 64] |= bit;
+    }
+  }
+}
+
+#ifdef __x86_64__
+
+// signed compares, bytes from 0x80 up are negative and never printable
+__attribute__((target("avx2"))) void
+classify_avx2(std::span<const std::byte> bytes, bitmask &printable,
+              bitmask &zero) {
+  const auto space_minus_one = _mm256_set1_epi8(0x1f);
+  const auto del = _mm256_set1_epi8(0x7f);
+  const auto tab = _mm256_set1_epi8('\t');
+  const auto nul = _mm256_setzero_si256();
+  std::size_t i = 0;
+  for (; i + 32 <= bytes.size(); i += 32) {
+    const auto block = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i *>(bytes.data() + i));
+    const auto in_range = _mm256_and_si256(
+        _mm256_cmpgt_epi8(block, space_minus_one),
+        _mm256_cmpgt_epi8(del, block));
+    const auto print_mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(
+        _mm256_or_si256(in_range, _mm256_cmpeq_epi8(block, tab))));
+    const auto zero_mask = static_cast<std::uint32_t>(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(block, nul)));
+    // i is a multiple of 32, so the block is one half of a word
+    const auto shift = i % 64;
+    printable[i / 64] |= static_cast<std::uint64_t>(print_mask) << shift;
+    zero[i / 64] |= static_cast<std::uint64_t>(zero_mask) << shift;
+  }
+  classify_scalar(bytes, i, printable, zero);
+}
+
+#endif
+
+// first position in [pos, end) whose bit equals value, end if there is none
+[[nodiscard]] std::size_t next_bit(const bitmask &mask, std::size_t pos,
+                                   bool value, std::size_t end) noexcept {
+  while (pos < end) {
+    const auto word = value ? mask[pos / 64] : ~mask[pos / 64];
+    const auto bits = word >> (pos % 64);
+    if (bits != 0) {
+      return std::min(end, pos + static_cast<std::size_t>(
+                                     std::countr_zero(bits)));
+    }
+    pos = (pos / 64 + 1) * 64;
+  }
+  return end;
+}
+
+// every run of set bits of at least min_size bits
+void append_runs(const bitmask &mask, std::size_t size, std::size_t min_size,
+                 string_encoding encoding, std::vector<string_run> &runs) {
+  std::size_t pos = 0;
+  while (pos < size) {
+    const auto begin = next_bit(mask, pos, true, size);
+    const auto end = next_bit(mask, begin, false, size);
+    if (end - begin >= min_size) {
+      runs.push_back(
+          {.offset = begin, .size = end - begin, .encoding = encoding});
+    }
+    pos = end;
+  }
+}
+
+// a utf-16le character at i is a printable byte at i and a zero at i + 1.
+// the characters of one alignment are spread out to cover both of their
+// bytes, which turns every utf-16le string into a run of set bits.
+void append_utf16_runs(const bitmask &printable, const bitmask &zero,
+                       std::size_t size, std::size_t min_length,
+                       std::vector<string_run> &runs) {
+  bitmask starts(printable.size());
+  for (std::size_t w = 0; w < printable.size(); ++w) {
+    const auto next_zero = w + 1 < zero.size() ? zero[w + 1] << 63 : 0;
+    starts[w] = printable[w] & ((zero[w] >> 1) | next_zero);
+  }
+  for (const auto alignment : {even_bits, odd_bits}) {
+    bitmask covered(starts.size());
+    std::uint64_t carry = 0;
+    for (std::size_t w = 0; w < starts.size(); ++w) {
+      const auto aligned = starts[w] & alignment;
+      covered[w] = aligned | (aligned << 1) | carry;
+      carry = aligned >> 63;
+    }
+    append_runs(covered, size, 2 * min_length, string_encoding::UTF16LE, runs);
+  }
+}
+
+} // namespace
+
+void find_strings(std::span<const std::byte> bytes,
+                  const strings_options &options,
+                  std::vector<string_run> &runs) {
+  find_strings(bytes, options, runs, active_search_kernel());
+}
+
+void find_strings(std::span<const std::byte> bytes,
+                  const strings_options &options, std::vector<string_run> &runs,
+                  search_kernel kernel) {
+  const auto words = (bytes.size() + 63) / 64;
+  bitmask printable(words);
+  bitmask zero(words);
+#ifdef __x86_64__
+  if (kernel == search_kernel::AVX2) {
+    classify_avx2(bytes, printable, zero);
+  } else {
+    classify_scalar(bytes, 0, printable, zero);
+  }
+#else
+  static_cast<void>(kernel);
+  classify_scalar(bytes, 0, printable, zero);
+#endif
+
+  const auto first = runs.size();
+  const auto min_length = std::max<std::size_t>(options.min_length, 1);
+  append_runs(printable, bytes.size(), min_length, string_encoding::ASCII,
+              runs);
+  if (options.utf16) {
+    append_utf16_runs(printable, zero, bytes.size(), min_length, runs);
+    std::ranges::sort(runs.begin() + static_cast<std::ptrdiff_t>(first),
+                      runs.end(), {}, &string_run::offset);
+  }
+}
+
+std::size_t
+scan_strings(const process &proc, std::span<const memory_region> regions,
+             const strings_options &strings,
+             const std::function<void(std::span<const found_string>)> &sink,
+             const scan_options &options) {
+  const auto overlap = strings.utf16 ? 2 * boundary_overlap : boundary_overlap;
+  std::optional<page_map> pages{};
+  if (!options.include_swapped) {
+    pages.emplace(proc);
+  }
+  // whether the scan read the byte in front of address, the way the chunk
+  // before it did: a page the scan skips as not resident, or cannot read,
+  // was not seen there
+  const auto read_before = [&](std::uintptr_t address) {
+    try {
+      if (pages && !pages->resident_pages(address - 1, 1).front()) {
+        return false;
+      }
+    } catch (const std::system_error &) {
+      return false;
+    }
+    std::array<std::byte, 1> byte{};
+    const auto read = try_read_memory(proc, address - 1, byte);
+    return read && *read == byte.size();
+  };
+  const auto counts = scan_regions<std::size_t>(
+      proc, regions, overlap, options,
+      [&](const memory_chunk &chunk, std::vector<std::size_t> &out) {
+        // a chunk owns the strings starting inside it or right at its end, so
+        // one that starts where a chunk boundary is belongs to the chunk
+        // before it. the next chunk drops the string it starts with, which
+        // was either found there or continues one found there, unless the
+        // chunk before could not read up to the boundary and never saw it.
+        const auto &region = regions[chunk.region];
+        const auto at_boundary =
+            chunk.address != region.begin() &&
+            (chunk.address - region.begin()) % options.chunk_size == 0;
+        std::optional<bool> continues{};
+        std::vector<string_run> runs{};
+        find_strings(chunk.bytes, strings, runs);
+        std::vector<found_string> found{};
+        for (const auto &run : runs) {
+          const std::size_t lead =
+              run.encoding == string_encoding::UTF16LE ? 1 : 0;
+          if (run.offset > chunk.size + lead) {
+            break;
+          }
+          if (at_boundary && run.offset <= lead) {
+            if (!continues) {
+              continues = read_before(chunk.address);
+            }
+            if (*continues) {
+              continue;
+            }
+          }
+          found_string string{.address = chunk.address + run.offset,
+                              .encoding = run.encoding};
+          const auto bytes = chunk.bytes.subspan(run.offset, run.size);
+          const std::size_t step =
+              run.encoding == string_encoding::UTF16LE ? 2 : 1;
+          string.text.reserve(run.size / step);
+          for (std::size_t i = 0; i < bytes.size(); i += step) {
+            string.text += std::to_integer<char>(bytes[i]);
+          }
+          found.push_back(std::move(string));
+        }
+        if (!found.empty()) {
+          sink(found);
+        }
+        out.push_back(found.size());
+      });
+  return std::reduce(counts.begin(), counts.end(), std::size_t{0});
+}
+
+} // namespace pp
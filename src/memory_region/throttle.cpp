@@ -0,0 +1,170 @@
+#include "memory_region/throttle.hpp"
+#include "util/read_file.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <format>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <thread>
+
+#ifdef __linux__
+#include <sched.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#else
+#error "only linux is supported"
+#endif
+
+namespace pp {
+
+namespace {
+
+constexpr auto sample_interval = std::chrono::milliseconds{250};
+constexpr double min_rate_ratio = 1.0 / 16;
+// cpu use above the baseline that is still taken as noise
+constexpr double tolerance_ratio = 1.2;
+constexpr double tolerance_cores = 0.05;
+
+// utime + stime of pid in clock ticks, nullopt once it is gone
+[[nodiscard]] std::optional<std::uint64_t> cpu_ticks(std::uint32_t pid) {
+  std::string stat;
+  try {
+    stat = read_file(std::format("/proc/{}/stat", pid));
+  } catch (const std::system_error &) {
+    return std::nullopt;
+  }
+  // comm may hold spaces and parentheses, the fields after it do not
+  const auto comm_end = stat.rfind(')');
+  if (comm_end == std::string::npos) {
+    return std::nullopt;
+  }
+  std::istringstream fields{stat.substr(comm_end + 1)};
+  std::string skipped;
+  // state is field 3, utime and stime are 14 and 15
+  for (int field = 3; field < 14; ++field) {
+    fields >> skipped;
+  }
+  std::uint64_t utime{0};
+  std::uint64_t stime{0};
+  if (!(fields >> utime >> stime)) {
+    return std::nullopt;
+  }
+  return utime + stime;
+}
+
+} // namespace
+
+rate_limiter::rate_limiter(std::size_t bytes_per_second)
+    : max_rate_{static_cast<double>(std::max<std::size_t>(bytes_per_second,
+                                                          1))},
+      rate_{max_rate_}, tokens_{max_rate_ / 10}, refilled_{clock::now()} {}
+
+void rate_limiter::adapt_to(std::span<const std::uint32_t> pids) {
+  const std::lock_guard lock{this->mutex_};
+  this->targets_.clear();
+  this->target_ticks_.clear();
+  for (const auto pid : pids) {
+    if (const auto ticks = cpu_ticks(pid)) {
+      this->targets_.push_back(pid);
+      this->target_ticks_.push_back(*ticks);
+    }
+  }
+  this->sampled_ = clock::now();
+  this->baseline_ = -1;
+}
+
+void rate_limiter::adapt(clock::time_point now) {
+  if (this->targets_.empty() || now - this->sampled_ < sample_interval) {
+    return;
+  }
+  static const auto ticks_per_second =
+      static_cast<double>(sysconf(_SC_CLK_TCK));
+  const auto seconds =
+      std::chrono::duration<double>(now - this->sampled_).count();
+  // targets that are gone are dropped, fewer ticks than before means the pid
+  // was taken by another process
+  bool changed = false;
+  std::uint64_t used_ticks{0};
+  std::size_t kept = 0;
+  for (std::size_t i = 0; i < this->targets_.size(); ++i) {
+    const auto ticks = cpu_ticks(this->targets_[i]);
+    if (!ticks) {
+      changed = true;
+      continue;
+    }
+    if (*ticks < this->target_ticks_[i]) {
+      changed = true;
+    } else {
+      used_ticks += *ticks - this->target_ticks_[i];
+    }
+    this->targets_[kept] = this->targets_[i];
+    this->target_ticks_[kept] = *ticks;
+    ++kept;
+  }
+  this->targets_.resize(kept);
+  this->target_ticks_.resize(kept);
+  this->sampled_ = now;
+  if (this->targets_.empty()) {
+    // nothing left to hold back for
+    this->rate_ = this->max_rate_;
+    return;
+  }
+  // the interval is measured again from this sample, a target that is gone
+  // would look like its cpu use dropped to nothing
+  if (changed) {
+    return;
+  }
+  const auto used =
+      static_cast<double>(used_ticks) / ticks_per_second / seconds;
+
+  if (this->baseline_ < 0 || used < this->baseline_) {
+    this->baseline_ = used;
+  }
+  if (used > this->baseline_ * tolerance_ratio + tolerance_cores) {
+    this->rate_ = std::max(this->rate_ / 2, this->max_rate_ * min_rate_ratio);
+  } else {
+    this->rate_ = std::min(this->rate_ + this->max_rate_ / 8, this->max_rate_);
+  }
+}
+
+void rate_limiter::acquire(std::size_t size) {
+  std::chrono::duration<double> wait{0};
+  {
+    const std::lock_guard lock{this->mutex_};
+    const auto now = clock::now();
+    this->adapt(now);
+    const auto elapsed =
+        std::chrono::duration<double>(now - this->refilled_).count();
+    this->refilled_ = now;
+    this->tokens_ = std::min(this->tokens_ + elapsed * this->rate_,
+                             this->rate_ / 10);
+    this->tokens_ -= static_cast<double>(size);
+    if (this->tokens_ < 0) {
+      wait = std::chrono::duration<double>{-this->tokens_ / this->rate_};
+    }
+  }
+  if (wait.count() > 0) {
+    std::this_thread::sleep_for(wait);
+  }
+}
+
+[[nodiscard]] std::size_t rate_limiter::rate() const {
+  const std::lock_guard lock{this->mutex_};
+  return static_cast<std::size_t>(this->rate_);
+}
+
+void lower_priority() {
+  const sched_param param{};
+  if (sched_setscheduler(0, SCHED_IDLE, &param) == 0) {
+    return;
+  }
+  if (setpriority(PRIO_PROCESS, 0, 19) == -1) {
+    throw std::system_error(errno, std::generic_category(),
+                            "unable to lower the scheduling priority");
+  }
+}
+
+} // namespace pp
@@ -0,0 +1,210 @@
+#include "memory_region/uring_reader.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <format>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#error "only linux is supported"
+#endif
+
+namespace pp {
+
+namespace {
+
+// the rings are shared with the kernel, which reads the sq tail and writes
+// the cq tail from another context
+[[nodiscard]] std::uint32_t load_acquire(std::uint32_t *value) noexcept {
+  return std::atomic_ref{*value}.load(std::memory_order_acquire);
+}
+
+void store_release(std::uint32_t *value, std::uint32_t desired) noexcept {
+  std::atomic_ref{*value}.store(desired, std::memory_order_release);
+}
+
+template <typename T>
+[[nodiscard]] T *ring_field(void *ring, std::uint32_t offset) noexcept {
+  return reinterpret_cast<T *>(static_cast<char *>(ring) + offset);
+}
+
+[[nodiscard]] void *map_ring(int fd, std::size_t size, off_t offset) {
+  auto *const ring = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE, fd, offset);
+  if (ring == MAP_FAILED) {
+    throw std::system_error(errno, std::generic_category(),
+                            "unable to map io_uring");
+  }
+  return ring;
+}
+
+} // namespace
+
+uring_reader::uring_reader(std::uint32_t id, std::size_t depth) {
+  const auto path = std::format("/proc/{}/mem", id);
+  this->mem_fd_ = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (this->mem_fd_ == -1) {
+    throw std::system_error(errno, std::generic_category(),
+                            std::format("unable to open file: {}", path));
+  }
+
+  io_uring_params params{};
+  const auto ring_fd = syscall(__NR_io_uring_setup,
+                               static_cast<unsigned>(std::max<std::size_t>(
+                                   depth, 1)),
+                               &params);
+  if (ring_fd < 0) {
+    const auto error = errno;
+    this->close();
+    throw std::system_error(error, std::generic_category(),
+                            "unable to set up io_uring");
+  }
+  this->ring_fd_ = static_cast<int>(ring_fd);
+  // the kernel rounds the entry count up to a power of two
+  this->depth_ = std::min<std::size_t>(params.sq_entries, params.cq_entries);
+
+  try {
+    this->sq_ring_size_ =
+        params.sq_off.array + params.sq_entries * sizeof(std::uint32_t);
+    this->cq_ring_size_ =
+        params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    // newer kernels map both rings with one mmap
+    if ((params.features & IORING_FEAT_SINGLE_MMAP) != 0) {
+      this->sq_ring_size_ = this->cq_ring_size_ =
+          std::max(this->sq_ring_size_, this->cq_ring_size_);
+    }
+    this->sq_ring_ =
+        map_ring(this->ring_fd_, this->sq_ring_size_, IORING_OFF_SQ_RING);
+    if ((params.features & IORING_FEAT_SINGLE_MMAP) != 0) {
+      this->cq_ring_ = this->sq_ring_;
+    } else {
+      this->cq_ring_ =
+          map_ring(this->ring_fd_, this->cq_ring_size_, IORING_OFF_CQ_RING);
+    }
+    this->sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    this->sqes_ = map_ring(this->ring_fd_, this->sqes_size_, IORING_OFF_SQES);
+  } catch (const std::system_error &) {
+    this->close();
+    throw;
+  }
+
+  this->sq_tail_ = ring_field<std::uint32_t>(this->sq_ring_, params.sq_off.tail);
+  this->sq_mask_ =
+      *ring_field<std::uint32_t>(this->sq_ring_, params.sq_off.ring_mask);
+  this->sq_array_ =
+      ring_field<std::uint32_t>(this->sq_ring_, params.sq_off.array);
+  this->cq_head_ = ring_field<std::uint32_t>(this->cq_ring_, params.cq_off.head);
+  this->cq_tail_ = ring_field<std::uint32_t>(this->cq_ring_, params.cq_off.tail);
+  this->cq_mask_ =
+      *ring_field<std::uint32_t>(this->cq_ring_, params.cq_off.ring_mask);
+  this->cqes_ = ring_field<void>(this->cq_ring_, params.cq_off.cqes);
+}
+
+void uring_reader::close() noexcept {
+  if (this->sqes_ != nullptr) {
+    munmap(this->sqes_, this->sqes_size_);
+  }
+  if (this->cq_ring_ != nullptr && this->cq_ring_ != this->sq_ring_) {
+    munmap(this->cq_ring_, this->cq_ring_size_);
+  }
+  if (this->sq_ring_ != nullptr) {
+    munmap(this->sq_ring_, this->sq_ring_size_);
+  }
+  if (this->ring_fd_ != -1) {
+    ::close(this->ring_fd_);
+  }
+  if (this->mem_fd_ != -1) {
+    ::close(this->mem_fd_);
+  }
+  this->sqes_ = this->cq_ring_ = this->sq_ring_ = nullptr;
+  this->ring_fd_ = this->mem_fd_ = -1;
+}
+
+uring_reader::~uring_reader() { this->close(); }
+
+[[nodiscard]] std::size_t uring_reader::depth() const noexcept {
+  return this->depth_;
+}
+
+[[nodiscard]] std::size_t uring_reader::in_flight() const noexcept {
+  return this->in_flight_;
+}
+
+void uring_reader::add(std::uint64_t tag, std::uintptr_t address,
+                       std::span<std::byte> out) {
+  if (this->in_flight_ >= this->depth_) {
+    throw std::length_error("io_uring queue is full");
+  }
+  const auto tail = *this->sq_tail_;
+  const auto index = tail & this->sq_mask_;
+  auto &sqe = static_cast<io_uring_sqe *>(this->sqes_)[index];
+  std::memset(&sqe, 0, sizeof(sqe));
+  sqe.opcode = IORING_OP_READ;
+  sqe.fd = this->mem_fd_;
+  sqe.off = address;
+  sqe.addr = reinterpret_cast<std::uintptr_t>(out.data());
+  sqe.len = static_cast<std::uint32_t>(out.size());
+  sqe.user_data = tag;
+  this->sq_array_[index] = index;
+  store_release(this->sq_tail_, tail + 1);
+  ++this->queued_;
+  ++this->in_flight_;
+}
+
+void uring_reader::submit() {
+  while (this->queued_ > 0) {
+    const auto submitted =
+        syscall(__NR_io_uring_enter, this->ring_fd_,
+                static_cast<unsigned>(this->queued_), 0u, 0u, nullptr, 0);
+    if (submitted < 0) {
+      if (errno == EINTR || errno == EAGAIN) {
+        continue;
+      }
+      throw std::system_error(errno, std::generic_category(),
+                              "unable to submit to io_uring");
+    }
+    this->queued_ -= static_cast<std::size_t>(submitted);
+  }
+}
+
+[[nodiscard]] uring_reader::completion uring_reader::wait() {
+  if (this->in_flight_ == 0) {
+    throw std::logic_error("no io_uring read in flight");
+  }
+  this->submit();
+  auto head = *this->cq_head_;
+  while (head == load_acquire(this->cq_tail_)) {
+    const auto entered =
+        syscall(__NR_io_uring_enter, this->ring_fd_, 0u, 1u,
+                static_cast<unsigned>(IORING_ENTER_GETEVENTS), nullptr, 0);
+    if (entered < 0 && errno != EINTR) {
+      throw std::system_error(errno, std::generic_category(),
+                              "unable to wait for io_uring");
+    }
+  }
+  const auto &cqe =
+      static_cast<const io_uring_cqe *>(this->cqes_)[head & this->cq_mask_];
+  completion done{.tag = cqe.user_data};
+  // like pread on /proc/<pid>/mem, EIO means nothing could be read
+  if (cqe.res >= 0) {
+    done.read = static_cast<std::size_t>(cqe.res);
+  } else if (-cqe.res == EIO || -cqe.res == EFAULT) {
+    done.read = 0;
+  } else {
+    done.read =
+        std::unexpected{std::error_code{-cqe.res, std::generic_category()}};
+  }
+  store_release(this->cq_head_, head + 1);
+  --this->in_flight_;
+  return done;
+}
+
+} // namespace pp
@@ -0,0 +1,228 @@
+#include "memory_region/value_scan.hpp"
+#include "memory_region/batch_io.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef __linux__
+#include <unistd.h>
+#else
+#error "only linux is supported"
+#endif
+
+namespace pp {
+
+namespace {
+
+[[nodiscard]] std::size_t page_size() {
+  static const auto size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+  return size;
+}
+
+template <typename T>
+[[nodiscard]] bool in_range(T value, T low, T high) noexcept {
+  return low <= value && value <= high;
+}
+
+template <typename T>
+[[nodiscard]] bool passes(scan_filter filter, T old_value, T new_value, T low,
+                          T high) noexcept {
+  switch (filter) {
+  case scan_filter::CHANGED:
+    return std::memcmp(&old_value, &new_value, sizeof(T)) != 0;
+  case scan_filter::UNCHANGED:
+    return std::memcmp(&old_value, &new_value, sizeof(T)) == 0;
+  case scan_filter::INCREASED:
+    return old_value < new_value;
+  case scan_filter::DECREASED:
+    return new_value < old_value;
+  case scan_filter::EQUAL:
+    return in_range(new_value, low, high);
+  }
+  return false;
+}
+
+} // namespace
+
+template <typename T>
+  requires std::is_arithmetic_v<T>
+void scan_session<T>::add(std::uintptr_t address, T value) {
+  const auto page = address & ~(page_size() - 1);
+  if (this->pages_.empty() || this->pages_.back().address != page) {
+    this->pages_.push_back({.address = page, .begin = this->offsets_.size()});
+  }
+  this->offsets_.push_back(static_cast<std::uint16_t>(address - page));
+  this->values_.push_back(value);
+}
+
+template <typename T>
+  requires std::is_arithmetic_v<T>
+void scan_session<T>::first_scan(std::span<const memory_region> regions,
+                                 T low, T high, const scan_options &options) {
+  struct chunk_hits {
+    std::uintptr_t address{0};
+    std::vector<std::size_t> offsets{};
+    std::vector<T> values{};
+  };
+
+  if (this->dirty_) {
+    this->dirty_->reset();
+  }
+
+  scan_stats stats{};
+  auto scan = options;
+  scan.stats = &stats;
+  // chunks start on page boundaries, so aligned values never cross them
+  auto hits = scan_regions<chunk_hits>(
+      this->proc_, regions, 0, scan,
+      [&](const memory_chunk &chunk, std::vector<chunk_hits> &out) {
+        chunk_hits found{.address = chunk.address};
+        find_values(chunk.bytes, low, high, true, found.offsets);
+        if (found.offsets.empty()) {
+          return;
+        }
+        found.values.resize(found.offsets.size());
+        for (std::size_t i = 0; i < found.offsets.size(); ++i) {
+          std::memcpy(&found.values[i], chunk.bytes.data() + found.offsets[i],
+                      sizeof(T));
+        }
+        out.push_back(std::move(found));
+      });
+  std::ranges::sort(hits, {}, &chunk_hits::address);
+  this->pages_read_ = stats.pages_read;
+  if (options.stats != nullptr) {
+    options.stats->pages_read += stats.pages_read;
+    options.stats->pages_skipped += stats.pages_skipped;
+  }
+
+  this->pages_.clear();
+  this->offsets_.clear();
+  this->values_.clear();
+  for (const auto &hit : hits) {
+    for (std::size_t i = 0; i < hit.offsets.size(); ++i) {
+      this->add(hit.address + hit.offsets[i], hit.values[i]);
+    }
+  }
+}
+
+template <typename T>
+  requires std::is_arithmetic_v<T>
+void scan_session<T>::next_scan(scan_filter filter, T low, T high) {
+  auto pages = std::move(this->pages_);
+  auto offsets = std::move(this->offsets_);
+  auto values = std::move(this->values_);
+  this->pages_ = {};
+  this->offsets_ = {};
+  this->values_ = {};
+
+  const auto candidates_end = [&](std::size_t page) {
+    return page + 1 < pages.size() ? pages[page + 1].begin : offsets.size();
+  };
+
+  // with dirty tracking, pages nothing wrote to since the last scan still
+  // hold the values read back then and are left alone
+  std::vector<bool> dirty(pages.size(), true);
+  if (this->dirty_) {
+    std::vector<std::uintptr_t> addresses(pages.size());
+    std::ranges::transform(pages, addresses.begin(), &candidate_page::address);
+    dirty = this->dirty_->take_dirty_pages(addresses);
+  }
+  this->pages_read_ = 0;
+
+  // only the span between the first and the last candidate of each page is
+  // read, a slice of pages at a time through one batch
+  constexpr std::size_t slice_pages = 1024;
+  std::vector<std::byte> buffer(slice_pages * page_size());
+  std::vector<std::span<const std::byte>> spans(slice_pages);
+  std::vector<std::size_t> requests(slice_pages);
+  batch_reader reader{this->proc_};
+  for (std::size_t slice = 0; slice < pages.size(); slice += slice_pages) {
+    const auto count = std::min(slice_pages, pages.size() - slice);
+    std::size_t used = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+      if (!dirty[slice + i]) {
+        continue;
+      }
+      const auto &page = pages[slice + i];
+      const auto first = offsets[page.begin];
+      const auto last = offsets[candidates_end(slice + i) - 1];
+      const auto bytes =
+          std::span{buffer}.subspan(used, last + sizeof(T) - first);
+      requests[i] = reader.add(page.address + first, bytes);
+      spans[i] = bytes;
+      used += bytes.size();
+    }
+    this->pages_read_ += reader.size();
+
+    // pages that became unreadable drop their candidates
+    const auto read = reader.submit();
+    for (std::size_t i = 0; i < count; ++i) {
+      const auto current = slice + i;
+      if (dirty[current] && !read[requests[i]]) {
+        continue;
+      }
+      const auto first = offsets[pages[current].begin];
+      for (auto c = pages[current].begin; c < candidates_end(current); ++c) {
+        auto value = values[c];
+        if (dirty[current]) {
+          std::memcpy(&value, spans[i].data() + (offsets[c] - first),
+                      sizeof(T));
+        }
+        if (passes(filter, values[c], value, low, high)) {
+          this->add(pages[current].address + offsets[c], value);
+        }
+      }
+    }
+  }
+}
+
+template <typename T>
+  requires std::is_arithmetic_v<T>
+[[nodiscard]] std::size_t scan_session<T>::pages_read() const noexcept {
+  return this->pages_read_;
+}
+
+template <typename T>
+  requires std::is_arithmetic_v<T>
+[[nodiscard]] std::size_t scan_session<T>::size() const noexcept {
+  return this->offsets_.size();
+}
+
+template <typename T>
+  requires std::is_arithmetic_v<T>
+[[nodiscard]] std::size_t scan_session<T>::page_count() const noexcept {
+  return this->pages_.size();
+}
+
+template <typename T>
+  requires std::is_arithmetic_v<T>
+[[nodiscard]] std::vector<value_candidate<T>>
+scan_session<T>::candidates(std::size_t max_count) const {
+  std::vector<value_candidate<T>> result{};
+  for (std::size_t page = 0;
+       page < this->pages_.size() && result.size() < max_count; ++page) {
+    const auto end = page + 1 < this->pages_.size()
+                         ? this->pages_[page + 1].begin
+                         : this->offsets_.size();
+    for (auto i = this->pages_[page].begin;
+         i < end && result.size() < max_count; ++i) {
+      result.push_back({.address = this->pages_[page].address +
+                                   this->offsets_[i],
+                        .value = this->values_[i]});
+    }
+  }
+  return result;
+}
+
+template class scan_session<std::int8_t>;
+template class scan_session<std::int16_t>;
+template class scan_session<std::int32_t>;
+template class scan_session<std::int64_t>;
+template class scan_session<std::uint8_t>;
+template class scan_session<std::uint16_t>;
+template class scan_session<std::uint32_t>;
+template class scan_session<std::uint64_t>;
+template class scan_session<float>;
+template class scan_session<double>;
+
+} // namespace pp
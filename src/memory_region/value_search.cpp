@@ -0,0 +1,253 @@
+#include "memory_region/value_search.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <limits>
+
+#ifdef __x86_64__
+#include <immintrin.h>
+#endif
+
+namespace pp {
+
+namespace {
+
+template <typename T>
+[[nodiscard]] T load(const std::byte *bytes) noexcept {
+  T value{};
+  std::memcpy(&value, bytes, sizeof(T));
+  return value;
+}
+
+// written so that nan is never in range
+template <typename T>
+[[nodiscard]] bool in_range(T value, T low, T high) noexcept {
+  return low <= value && value <= high;
+}
+
+template <typename T, bool Aligned>
+void find_scalar(const std::byte *bytes, std::size_t size, std::size_t begin,
+                 T low, T high, std::vector<std::size_t> &offsets) {
+  constexpr std::size_t step = Aligned ? sizeof(T) : 1;
+  for (auto offset = begin; offset + sizeof(T) <= size; offset += step) {
+    if (in_range(load<T>(bytes + offset), low, high)) {
+      offsets.push_back(offset);
+    }
+  }
+}
+
+#ifdef __x86_64__
+
+// lanes of one 32 byte vector. match() returns a byte mask in the layout of
+// _mm256_movemask_epi8 with every byte of a lane in [low, high] set.
+template <typename T> struct avx2_lanes {
+  // unsigned values are moved into the signed range so the signed compares
+  // order them correctly
+  [[nodiscard]] __attribute__((target("avx2"))) static __m256i
+  bias(__m256i value) noexcept {
+    if constexpr (std::is_signed_v<T>) {
+      return value;
+    } else if constexpr (sizeof(T) == 1) {
+      return _mm256_xor_si256(value, _mm256_set1_epi8(-0x80));
+    } else if constexpr (sizeof(T) == 2) {
+      return _mm256_xor_si256(value, _mm256_set1_epi16(-0x8000));
+    } else if constexpr (sizeof(T) == 4) {
+      return _mm256_xor_si256(
+          value, _mm256_set1_epi32(std::numeric_limits<std::int32_t>::min()));
+    } else {
+      return _mm256_xor_si256(
+          value, _mm256_set1_epi64x(std::numeric_limits<std::int64_t>::min()));
+    }
+  }
+
+  [[nodiscard]] __attribute__((target("avx2"))) static __m256i
+  greater(__m256i a, __m256i b) noexcept {
+    if constexpr (sizeof(T) == 1) {
+      return _mm256_cmpgt_epi8(a, b);
+    } else if constexpr (sizeof(T) == 2) {
+      return _mm256_cmpgt_epi16(a, b);
+    } else if constexpr (sizeof(T) == 4) {
+      return _mm256_cmpgt_epi32(a, b);
+    } else {
+      return _mm256_cmpgt_epi64(a, b);
+    }
+  }
+
+  [[nodiscard]] __attribute__((target("avx2"))) static __m256i
+  splat(T value) noexcept {
+    __m256i result{};
+    if constexpr (sizeof(T) == 1) {
+      result = _mm256_set1_epi8(std::bit_cast<char>(value));
+    } else if constexpr (sizeof(T) == 2) {
+      result = _mm256_set1_epi16(std::bit_cast<std::int16_t>(value));
+    } else if constexpr (sizeof(T) == 4) {
+      result = _mm256_set1_epi32(std::bit_cast<std::int32_t>(value));
+    } else {
+      result = _mm256_set1_epi64x(std::bit_cast<std::int64_t>(value));
+    }
+    return bias(result);
+  }
+
+  [[nodiscard]] __attribute__((target("avx2"))) static std::uint32_t
+  match(const std::byte *bytes, __m256i low, __m256i high) noexcept {
+    const auto value =
+        bias(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(bytes)));
+    const auto outside =
+        _mm256_or_si256(greater(low, value), greater(value, high));
+    return ~static_cast<std::uint32_t>(_mm256_movemask_epi8(outside));
+  }
+};
+
+template <> struct avx2_lanes<float> {
+  [[nodiscard]] __attribute__((target("avx2"))) static __m256
+  splat(float value) noexcept {
+    return _mm256_set1_ps(value);
+  }
+
+  // ordered compares are false for nan
+  [[nodiscard]] __attribute__((target("avx2"))) static std::uint32_t
+  match(const std::byte *bytes, __m256 low, __m256 high) noexcept {
+    const auto value = _mm256_loadu_ps(reinterpret_cast<const float *>(bytes));
+    const auto inside = _mm256_and_ps(_mm256_cmp_ps(value, low, _CMP_GE_OQ),
+                                      _mm256_cmp_ps(value, high, _CMP_LE_OQ));
+    return static_cast<std::uint32_t>(
+        _mm256_movemask_epi8(_mm256_castps_si256(inside)));
+  }
+};
+
+template <> struct avx2_lanes<double> {
+  [[nodiscard]] __attribute__((target("avx2"))) static __m256d
+  splat(double value) noexcept {
+    return _mm256_set1_pd(value);
+  }
+
+  [[nodiscard]] __attribute__((target("avx2"))) static std::uint32_t
+  match(const std::byte *bytes, __m256d low, __m256d high) noexcept {
+    const auto value =
+        _mm256_loadu_pd(reinterpret_cast<const double *>(bytes));
+    const auto inside = _mm256_and_pd(_mm256_cmp_pd(value, low, _CMP_GE_OQ),
+                                      _mm256_cmp_pd(value, high, _CMP_LE_OQ));
+    return static_cast<std::uint32_t>(
+        _mm256_movemask_epi8(_mm256_castpd_si256(inside)));
+  }
+};
+
+// one bit at the first byte of every lane
+template <typename T> [[nodiscard]] consteval std::uint32_t lane_starts() {
+  std::uint32_t mask{0};
+  for (std::size_t bit = 0; bit < 32; bit += sizeof(T)) {
+    mask |= 1u << bit;
+  }
+  return mask;
+}
+
+// unaligned scans compare the block once per shift in [0, sizeof(T)). a lane
+// match at shift s is a value starting s bytes after its lane, so shifting the
+// lane starts by s merges all passes into one mask of start offsets, already
+// in order.
+template <typename T, bool Aligned>
+__attribute__((target("avx2"))) void
+find_avx2(const std::byte *bytes, std::size_t size, T low, T high,
+          std::vector<std::size_t> &offsets) {
+  using lanes = avx2_lanes<T>;
+  constexpr std::size_t shifts = Aligned ? 1 : sizeof(T);
+  const auto low_lanes = lanes::splat(low);
+  const auto high_lanes = lanes::splat(high);
+  std::size_t i = 0;
+  for (; i + (shifts - 1) + 32 <= size; i += 32) {
+    std::uint32_t mask{0};
+    for (std::size_t shift = 0; shift < shifts; ++shift) {
+      mask |= (lanes::match(bytes + i + shift, low_lanes, high_lanes) &
+               lane_starts<T>())
+              << shift;
+    }
+    while (mask != 0) {
+      offsets.push_back(i + static_cast<std::size_t>(std::countr_zero(mask)));
+      mask &= mask - 1;
+    }
+  }
+  find_scalar<T, Aligned>(bytes, size, i, low, high, offsets);
+}
+
+#endif
+
+} // namespace
+
+template <typename T>
+  requires std::is_arithmetic_v<T>
+void find_values(std::span<const std::byte> bytes, T low, T high, bool aligned,
+                 std::vector<std::size_t> &offsets) {
+  find_values(bytes, low, high, aligned, offsets, active_search_kernel());
+}
+
+template <typename T>
+  requires std::is_arithmetic_v<T>
+void find_values(std::span<const std::byte> bytes, T low, T high, bool aligned,
+                 std::vector<std::size_t> &offsets, search_kernel kernel) {
+#ifdef __x86_64__
+  if (kernel == search_kernel::AVX2) {
+    if (aligned) {
+      find_avx2<T, true>(bytes.data(), bytes.size(), low, high, offsets);
+    } else {
+      find_avx2<T, false>(bytes.data(), bytes.size(), low, high, offsets);
+    }
+    return;
+  }
+#else
+  static_cast<void>(kernel);
+#endif
+  if (aligned) {
+    find_scalar<T, true>(bytes.data(), bytes.size(), 0, low, high, offsets);
+  } else {
+    find_scalar<T, false>(bytes.data(), bytes.size(), 0, low, high, offsets);
+  }
+}
+
+template <typename T>
+  requires std::is_arithmetic_v<T>
+[[nodiscard]] std::vector<value_candidate<T>>
+search_values(const process &proc, std::span<const memory_region> regions,
+              T low, T high, bool aligned, const scan_options &options) {
+  // unaligned values may start in the last sizeof(T) - 1 bytes of a chunk
+  const std::size_t overlap = aligned ? 0 : sizeof(T) - 1;
+  auto matches = scan_regions<value_candidate<T>>(
+      proc, regions, overlap, options,
+      [&](const memory_chunk &chunk, std::vector<value_candidate<T>> &out) {
+        std::vector<std::size_t> offsets{};
+        find_values(chunk.bytes, low, high, aligned, offsets);
+        for (const auto offset : offsets) {
+          if (offset >= chunk.size) {
+            break;
+          }
+          out.push_back({.address = chunk.address + offset,
+                         .value = load<T>(chunk.bytes.data() + offset)});
+        }
+      });
+  std::ranges::sort(matches, {}, &value_candidate<T>::address);
+  return matches;
+}
+
+#define PP_INSTANTIATE_VALUE_SEARCH(T)                                         \
+  template void find_values<T>(std::span<const std::byte>, T, T, bool,        \
+                               std::vector<std::size_t> &);                    \
+  template void find_values<T>(std::span<const std::byte>, T, T, bool,        \
+                               std::vector<std::size_t> &, search_kernel);     \
+  template std::vector<value_candidate<T>> search_values<T>(                   \
+      const process &, std::span<const memory_region>, T, T, bool,             \
+      const scan_options &);
+
+PP_INSTANTIATE_VALUE_SEARCH(std::int8_t)
+PP_INSTANTIATE_VALUE_SEARCH(std::int16_t)
+PP_INSTANTIATE_VALUE_SEARCH(std::int32_t)
+PP_INSTANTIATE_VALUE_SEARCH(std::int64_t)
+PP_INSTANTIATE_VALUE_SEARCH(std::uint8_t)
+PP_INSTANTIATE_VALUE_SEARCH(std::uint16_t)
+PP_INSTANTIATE_VALUE_SEARCH(std::uint32_t)
+PP_INSTANTIATE_VALUE_SEARCH(std::uint64_t)
+PP_INSTANTIATE_VALUE_SEARCH(float)
+PP_INSTANTIATE_VALUE_SEARCH(double)
+
+#undef PP_INSTANTIATE_VALUE_SEARCH
+
+} // namespace pp
@@ -121,8 +121,13 @@ namespace pp {
   const auto pids = get_all_pids();
   for (const auto &pid : pids) {
     process proc{pid};
-    if (proc.name() == name) {
-      processes.push_back(proc);
+    try {
+      if (proc.name() == name) {
+        processes.push_back(proc);
+      }
+    } catch (const std::filesystem::filesystem_error &) {
+      // exited after /proc was listed
+      continue;
     }
   }
   if (processes.empty()) {
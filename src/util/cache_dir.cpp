@@ -0,0 +1,20 @@
+#include "util/cache_dir.hpp"
+
+#include <cstdlib>
+#include <stdexcept>
+
+namespace pp {
+
+[[nodiscard]] std::filesystem::path cache_dir() {
+  if (const auto *const cache = std::getenv("XDG_CACHE_HOME");
+      cache != nullptr && *cache != '\0') {
+    return std::filesystem::path{cache} / "pp";
+  }
+  const auto *const home = std::getenv("HOME");
+  if (home == nullptr) {
+    throw std::runtime_error("neither XDG_CACHE_HOME nor HOME is set");
+  }
+  return std::filesystem::path{home} / ".cache" / "pp";
+}
+
+} // namespace pp
@@ -0,0 +1,142 @@
+#include "util/work_stealing_pool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace pp {
+
+namespace {
+
+// [begin, end) of task indices packed into one word so that the owner and the
+// thieves can both shrink it with a single compare-and-swap
+class task_range {
+  std::atomic<std::uint64_t> range_{0};
+
+  [[nodiscard]] static constexpr std::uint64_t pack(std::uint64_t begin,
+                                                    std::uint64_t end) {
+    return (begin << 32) | end;
+  }
+
+public:
+  void assign(std::uint64_t begin, std::uint64_t end) noexcept {
+    this->range_.store(pack(begin, end), std::memory_order_release);
+  }
+
+  [[nodiscard]] bool pop(std::size_t &task) noexcept {
+    auto range = this->range_.load(std::memory_order_acquire);
+    while (true) {
+      const auto begin = range >> 32;
+      const auto end = range & 0xffffffff;
+      if (begin >= end) {
+        return false;
+      }
+      if (this->range_.compare_exchange_weak(range, pack(begin + 1, end),
+                                             std::memory_order_acq_rel)) {
+        task = static_cast<std::size_t>(begin);
+        return true;
+      }
+    }
+  }
+
+  // takes the upper half of the remaining tasks
+  [[nodiscard]] bool steal(std::uint64_t &begin, std::uint64_t &end) noexcept {
+    auto range = this->range_.load(std::memory_order_acquire);
+    while (true) {
+      const auto victim_begin = range >> 32;
+      const auto victim_end = range & 0xffffffff;
+      if (victim_begin >= victim_end) {
+        return false;
+      }
+      const auto mid = victim_begin + (victim_end - victim_begin) / 2;
+      if (this->range_.compare_exchange_weak(range, pack(victim_begin, mid),
+                                             std::memory_order_acq_rel)) {
+        begin = mid;
+        end = victim_end;
+        return true;
+      }
+    }
+  }
+};
+
+} // namespace
+
+work_stealing_pool::work_stealing_pool(std::size_t thread_count)
+    : thread_count_{thread_count != 0
+                        ? thread_count
+                        : std::max<std::size_t>(
+                              1, std::thread::hardware_concurrency())} {}
+
+[[nodiscard]] std::size_t work_stealing_pool::size() const noexcept {
+  return this->thread_count_;
+}
+
+void work_stealing_pool::run(
+    std::size_t task_count,
+    const std::function<void(std::size_t worker, std::size_t task)> &task)
+    const {
+  if (task_count == 0) {
+    return;
+  }
+  if (task_count > std::numeric_limits<std::uint32_t>::max()) {
+    throw std::length_error("too many tasks for a single pool run");
+  }
+  const auto workers = std::min(this->thread_count_, task_count);
+  const auto ranges = std::make_unique<task_range[]>(workers);
+  for (std::size_t i = 0; i < workers; ++i) {
+    ranges[i].assign(task_count * i / workers, task_count * (i + 1) / workers);
+  }
+
+  std::atomic<bool> failed{false};
+  std::exception_ptr error{nullptr};
+  std::once_flag error_once{};
+
+  const auto work = [&](std::size_t worker) {
+    try {
+      std::size_t current{0};
+      while (!failed.load(std::memory_order_relaxed)) {
+        if (ranges[worker].pop(current)) {
+          task(worker, current);
+          continue;
+        }
+        bool stolen = false;
+        for (std::size_t i = 1; i < workers && !stolen; ++i) {
+          std::uint64_t begin{0};
+          std::uint64_t end{0};
+          if (ranges[(worker + i) % workers].steal(begin, end)) {
+            ranges[worker].assign(begin, end);
+            stolen = true;
+          }
+        }
+        if (!stolen) {
+          return;
+        }
+      }
+    } catch (...) {
+      std::call_once(error_once, [&] { error = std::current_exception(); });
+      failed.store(true, std::memory_order_relaxed);
+    }
+  };
+
+  {
+    std::vector<std::jthread> threads{};
+    threads.reserve(workers - 1);
+    for (std::size_t i = 1; i < workers; ++i) {
+      threads.emplace_back(work, i);
+    }
+    work(0);
+  }
+
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+} // namespace pp